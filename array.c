@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include "array.h"
 #include "sort.h"
 
@@ -11,6 +12,27 @@ static void array_destroy_data(Array *self, void *data) {
 
 #define MIN_SIZE 16
 
+// Static function: Get the number of bytes a slot takes, the element size or, in pointer mode, a pointer's
+static inline size_t array_slot_size(Array *self) {
+    return self->elem_size != 0 ? self->elem_size : sizeof(void *);
+}
+
+// Static function: Get the address of the slot at index
+static inline void *array_slot(Array *self, size_t index) {
+    return (char *)self->data + index * array_slot_size(self);
+}
+
+// Static function: Get the element at index as the callbacks see it, the stored pointer or, for inline
+// elements, the address of the element
+static inline void *array_elem(Array *self, size_t index) {
+    return self->elem_size != 0 ? (char *)self->data + index * self->elem_size : self->data[index];
+}
+
+// Number of searches array_lower_bound_batch runs in lockstep, and the array length from which
+// it does: below it the array stays in cache and there are no misses to overlap
+#define ARRAY_SEARCH_INTERLEAVE 16
+#define ARRAY_SEARCH_INTERLEAVE_MIN (1 << 18)
+
 // Create a new dynamic array
 Array *array_create(DataDestroyFunc data_destroy, void *ctx) {
     Array *self = STL_MALLOC(sizeof(Array));
@@ -20,6 +42,23 @@ Array *array_create(DataDestroyFunc data_destroy, void *ctx) {
         self->alloc_size = MIN_SIZE;
         self->data_destroy = data_destroy;
         self->data_destroy_ctx = ctx;
+        self->elem_size = 0;
+    }
+    return self;
+}
+
+// Create a new dynamic array storing elements of elem_size bytes inline
+Array *array_create_inline(size_t elem_size, DataDestroyFunc data_destroy, void *ctx) {
+    return_val_if_fail(elem_size > 0, NULL);
+
+    Array *self = STL_MALLOC(sizeof(Array));
+    if (self != NULL) {
+        self->data = STL_MALLOC(MIN_SIZE * elem_size);
+        self->size = 0;
+        self->alloc_size = MIN_SIZE;
+        self->data_destroy = data_destroy;
+        self->data_destroy_ctx = ctx;
+        self->elem_size = elem_size;
     }
     return self;
 }
@@ -28,6 +67,9 @@ Array *array_create(DataDestroyFunc data_destroy, void *ctx) {
 static int array_expand(Array *self, size_t need) {
     return_val_if_fail(self != NULL, ERR_NIL);
 
+    if (self->size + need <= self->alloc_size) {
+        return OK;
+    }
     size_t alloc_size = self->alloc_size;
     while ((self->size + need) > alloc_size) {
         if (alloc_size == 0) {
@@ -39,7 +81,7 @@ static int array_expand(Array *self, size_t need) {
         }
     }
 
-    void **data = (void **) realloc(self->data, sizeof(void *) * alloc_size);
+    void **data = (void **) realloc(self->data, array_slot_size(self) * alloc_size);
     if (data != NULL) {
         self->data = data;
         self->alloc_size = alloc_size;
@@ -54,8 +96,10 @@ static int array_shrink(Array *self) {
 
     if ((self->size < (self->alloc_size >> 1)) && (self->alloc_size > MIN_SIZE)) {
         size_t alloc_size = self->size + (self->size >> 1);
+        // realloc to zero bytes may free the buffer and return NULL, so keep a minimal one
+        alloc_size = alloc_size > MIN_SIZE ? alloc_size : MIN_SIZE;
 
-        void **data = (void **) realloc(self->data, sizeof(void *) * alloc_size);
+        void **data = (void **) realloc(self->data, array_slot_size(self) * alloc_size);
         if (data != NULL) {
             self->data = data;
             self->alloc_size = alloc_size;
@@ -67,15 +111,26 @@ static int array_shrink(Array *self) {
 // Insert data at the specified index
 int array_insert(Array *self, size_t index, void *data) {
     size_t cursor = index;
-    return_val_if_fail(self != NULL, ERR_NIL);
+    size_t offset = SIZE_MAX;
+    return_val_if_fail(self != NULL && (self->elem_size == 0 || data != NULL), ERR_NIL);
     cursor = cursor < self->size ? cursor : self->size;
 
+    // An inline element of this array inserted again moves with the buffer, so it is found again by its offset
+    if (self->elem_size != 0 && (char *)data >= (char *)self->data &&
+        (char *)data < (char *)array_slot(self, self->size)) {
+        offset = (size_t)((char *)data - (char *)self->data);
+    }
+
     if (array_expand(self, 1) == 0) {
-        size_t i = 0;
-        for (i = self->size; i > cursor; i--) {
-            self->data[i] = self->data[i - 1];
+        memmove(array_slot(self, cursor + 1), array_slot(self, cursor), (self->size - cursor) * array_slot_size(self));
+        if (offset != SIZE_MAX) {
+            data = (char *)self->data + offset + (offset >= cursor * self->elem_size ? self->elem_size : 0);
+        }
+        if (self->elem_size != 0) {
+            memcpy(array_slot(self, cursor), data, self->elem_size);
+        } else {
+            self->data[cursor] = data;
         }
-        self->data[cursor] = data;
         self->size++;
         return OK;
     }
@@ -94,33 +149,61 @@ int array_append(Array *self, void *data) {
 
 // Delete data at the specified index
 int array_delete(Array *self, size_t index) {
-    size_t i = 0;
     return_val_if_fail(self != NULL && self->size > index, ERR_NIL);
 
-    array_destroy_data(self, self->data[index]);
-    for (i = index; (i + 1) < self->size; i++) {
-        self->data[i] = self->data[i + 1];
-    }
+    array_destroy_data(self, array_elem(self, index));
+    memmove(array_slot(self, index), array_slot(self, index + 1), (self->size - index - 1) * array_slot_size(self));
 
     self->size--;
     array_shrink(self);
     return OK;
 }
 
+// Resize the array to size elements, destroying the ones cut off and filling new slots with NULL
+int array_resize(Array *self, size_t size) {
+    size_t i = 0;
+    return_val_if_fail(self != NULL, ERR_NIL);
+
+    if (size > self->size) {
+        if (array_expand(self, size - self->size) != OK) {
+            return ERR_OOM;
+        }
+        memset(array_slot(self, self->size), 0, (size - self->size) * array_slot_size(self));
+        self->size = size;
+        return OK;
+    }
+    for (i = size; i < self->size; i++) {
+        array_destroy_data(self, array_elem(self, i));
+    }
+    self->size = size;
+    array_shrink(self);
+    return OK;
+}
+
 // Get data by index
 int array_get_by_index(Array *self, size_t index, void **data) {
     return_val_if_fail(self != NULL && data != NULL && index < self->size, ERR_NIL);
-    *data = self->data[index];
+    *data = array_elem(self, index);
     return OK;
 }
 
 // Set data at the specified index
 int array_set_by_index(Array *self, size_t index, void *data) {
-    return_val_if_fail(self != NULL && index < self->size, ERR_NIL);
-    self->data[index] = data;
+    return_val_if_fail(self != NULL && index < self->size && (self->elem_size == 0 || data != NULL), ERR_NIL);
+    if (self->elem_size != 0) {
+        memmove(array_slot(self, index), data, self->elem_size);
+    } else {
+        self->data[index] = data;
+    }
     return OK;
 }
 
+// Get the element at index, or NULL if index is out of range
+void *array_at(Array *self, size_t index) {
+    return_val_if_fail(self != NULL && index < self->size, NULL);
+    return array_elem(self, index);
+}
+
 // Get the length of the array
 size_t array_length(Array *self) {
     return_val_if_fail(self != NULL, 0);
@@ -133,7 +216,7 @@ int array_foreach(Array *self, DataVisitFunc visit, void *ctx) {
     return_val_if_fail(self != NULL && visit != NULL, ERR_NIL);
 
     for (i = 0; i < self->size; i++) {
-        if (!visit(ctx, i, self->data[i])) {
+        if (!visit(ctx, i, array_elem(self, i))) {
             break;
         };
     }
@@ -146,7 +229,7 @@ int array_find(Array *self, DataCompareFunc cmp, void *ctx) {
     return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
 
     for (i = 0; i < self->size; i++) {
-        if (cmp(ctx, self->data[i]) == 0) {
+        if (cmp(ctx, array_elem(self, i)) == 0) {
             break;
         }
     }
@@ -155,24 +238,298 @@ int array_find(Array *self, DataCompareFunc cmp, void *ctx) {
 
 // Sort the data in the array
 int array_sort(Array *self, DataCompareFunc cmp, DataSwapFunc swap) {
-    return_val_if_fail(self != NULL && swap != NULL && cmp != NULL, ERR_NIL);
-    quick_sort(self,
-               0,
-               self->size - 1,
-               (SortGetFunc)array_get_by_index,
-               (SortSetFunc)array_set_by_index,
-               (SortCmpFunc)cmp,
-               swap);
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+    // Elements are moved directly in self->data, so swap is not needed
+    (void)swap;
+    if (self->elem_size != 0) {
+        quick_sort_inline(self->data, self->size, self->elem_size, (SortCmpFunc)cmp);
+    } else {
+        quick_sort_ptr(self->data, self->size, (SortCmpFunc)cmp);
+    }
     return OK;
 }
 
+// Static function: Get the elements as an array of pointers for the pointer sorts: the data itself or, for
+// inline elements, a temporary array of pointers to them. Returns NULL if it cannot be allocated.
+static void **array_sort_view(Array *self) {
+    size_t i = 0;
+
+    if (self->elem_size == 0) {
+        return self->data;
+    }
+    void **view = STL_MALLOC((self->size > 0 ? self->size : 1) * sizeof(void *));
+    if (view != NULL) {
+        for (i = 0; i < self->size; i++) {
+            view[i] = array_slot(self, i);
+        }
+    }
+    return view;
+}
+
+// Static function: Finish a pointer sort run on the view from array_sort_view. Inline elements are copied
+// into the order of the view, unless the sort failed with ret, and the view is freed. Returns ret, or ERR_OOM
+// if the reordered copy cannot be allocated.
+static int array_sort_apply(Array *self, void **view, int ret) {
+    size_t i = 0;
+
+    if (view == self->data) {
+        return ret;
+    }
+    if (ret == OK) {
+        char *data = STL_MALLOC(self->alloc_size * self->elem_size);
+        if (data == NULL) {
+            ret = ERR_OOM;
+        } else {
+            for (i = 0; i < self->size; i++) {
+                memcpy(data + i * self->elem_size, view[i], self->elem_size);
+            }
+            STL_FREE(self->data);
+            self->data = (void **)data;
+        }
+    }
+    STL_FREE(view);
+    return ret;
+}
+
+// Sort the data in the array, keeping equal elements in their original order
+int array_sort_stable(Array *self, DataCompareFunc cmp) {
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+    void **view = array_sort_view(self);
+    if (view == NULL) {
+        return ERR_OOM;
+    }
+    return array_sort_apply(self, view, tim_sort_ptr(view, self->size, (SortCmpFunc)cmp));
+}
+
+// Reorder the data so that the element at nth is the one a full sort would put there
+int array_nth_element(Array *self, size_t nth, DataCompareFunc cmp) {
+    return_val_if_fail(self != NULL && cmp != NULL && nth < self->size, ERR_NIL);
+    void **view = array_sort_view(self);
+    if (view == NULL) {
+        return ERR_OOM;
+    }
+    nth_element_ptr(view, self->size, nth, (SortCmpFunc)cmp);
+    return array_sort_apply(self, view, OK);
+}
+
+// Move the k smallest elements, in sorted order, to the front of the array
+int array_partial_sort(Array *self, size_t k, DataCompareFunc cmp) {
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+    void **view = array_sort_view(self);
+    if (view == NULL) {
+        return ERR_OOM;
+    }
+    partial_sort_ptr(view, self->size, k, (SortCmpFunc)cmp);
+    return array_sort_apply(self, view, OK);
+}
+
+// Store the k smallest elements, in sorted order, in dest
+int array_top_k(Array *self, size_t k, DataCompareFunc cmp, Array *dest) {
+    size_t i = 0;
+    return_val_if_fail(self != NULL && cmp != NULL && dest != NULL && dest != self, ERR_NIL);
+    return_val_if_fail(dest->elem_size == self->elem_size, ERR_NIL);
+
+    if (array_resize(dest, 0) != OK || array_resize(dest, k < self->size ? k : self->size) != OK) {
+        return ERR_OOM;
+    }
+    if (self->elem_size == 0) {
+        top_k_ptr(self->data, self->size, dest->data, dest->size, (SortCmpFunc)cmp);
+        return OK;
+    }
+
+    // Select pointers to the inline elements, then copy the elements they point at
+    void **view = array_sort_view(self);
+    void **best = STL_MALLOC((dest->size > 0 ? dest->size : 1) * sizeof(void *));
+    if (view == NULL || best == NULL) {
+        STL_FREE(view);
+        STL_FREE(best);
+        return ERR_OOM;
+    }
+    top_k_ptr(view, self->size, best, dest->size, (SortCmpFunc)cmp);
+    for (i = 0; i < dest->size; i++) {
+        memcpy(array_slot(dest, i), best[i], self->elem_size);
+    }
+    STL_FREE(view);
+    STL_FREE(best);
+    return OK;
+}
+
+// Static function: Get the lower bound (or, with upper set, the upper bound) of data in the sorted range
+// base[0, n) of pointers. Each step keeps one half by masking the step rather than with a branch, so the loop
+// stays branch free even where upper is not a constant, and prefetches the slots both possible halves probe
+// next while the comparison runs.
+static inline size_t array_bound_ptr(void **base, size_t n, void *data, DataCompareFunc cmp, BOOL upper) {
+    void **first = base;
+
+    if (n == 0) {
+        return 0;
+    }
+    while (n > 1) {
+        size_t half = n / 2;
+        STL_PREFETCH(&base[half / 2]);
+        STL_PREFETCH(&base[half + half / 2]);
+        int ret = cmp(base[half], data);
+        base += half & (0 - ((size_t)(ret < 0) | ((size_t)upper & (size_t)(ret == 0))));
+        n -= half;
+    }
+    int ret = cmp(*base, data);
+    return (size_t)(base - first) + (ret < 0 || (upper && ret == 0));
+}
+
+// Static function: Get the lower or upper bound of data in a sorted range of n inline elements of size bytes
+// at base, like array_bound_ptr
+static inline size_t array_bound_inline(char *base, size_t n, size_t size, void *data, DataCompareFunc cmp, BOOL upper) {
+    char *first = base;
+
+    if (n == 0) {
+        return 0;
+    }
+    while (n > 1) {
+        size_t half = n / 2;
+        STL_PREFETCH(base + half / 2 * size);
+        STL_PREFETCH(base + (half + half / 2) * size);
+        int ret = cmp(base + half * size, data);
+        base += (half * size) & (0 - ((size_t)(ret < 0) | ((size_t)upper & (size_t)(ret == 0))));
+        n -= half;
+    }
+    int ret = cmp(base, data);
+    return (size_t)(base - first) / size + (ret < 0 || (upper && ret == 0));
+}
+
+// Static function: Get the lower or upper bound of data in the sorted range [first, first + n) of the array,
+// as an offset from first. The storage mode is checked once here, so the search loops stay branch free.
+static inline size_t array_bound(Array *self, size_t first, size_t n, void *data, DataCompareFunc cmp, BOOL upper) {
+    if (self->elem_size != 0) {
+        return array_bound_inline(array_slot(self, first), n, self->elem_size, data, cmp, upper);
+    }
+    return array_bound_ptr(self->data + first, n, data, cmp, upper);
+}
+
+// Get the index of the first element that does not order before data
+size_t array_lower_bound(Array *self, void *data, DataCompareFunc cmp) {
+    return_val_if_fail(self != NULL && cmp != NULL, 0);
+    return array_bound(self, 0, self->size, data, cmp, FALSE);
+}
+
+// Get the index of the first element that orders after data
+size_t array_upper_bound(Array *self, void *data, DataCompareFunc cmp) {
+    return_val_if_fail(self != NULL && cmp != NULL, 0);
+    return array_bound(self, 0, self->size, data, cmp, TRUE);
+}
+
+// Get the range of the elements equal to data
+int array_equal_range(Array *self, void *data, DataCompareFunc cmp, size_t *first, size_t *last) {
+    return_val_if_fail(self != NULL && cmp != NULL && first != NULL && last != NULL, ERR_NIL);
+    *first = array_bound(self, 0, self->size, data, cmp, FALSE);
+    *last = *first + array_bound(self, *first, self->size - *first, data, cmp, TRUE);
+    return OK;
+}
+
+// Static function: Store the lower bounds of n keys, n at most ARRAY_SEARCH_INTERLEAVE, searching for all of them
+// in lockstep. The searches narrow their ranges in the same steps, and their loads do not depend on each other,
+// so the cache misses of one step overlap instead of following one another.
+static void array_bound_interleaved(Array *self, void **keys, size_t n, DataCompareFunc cmp, size_t *results) {
+    size_t base[ARRAY_SEARCH_INTERLEAVE];
+    size_t len = self->size;
+    size_t i = 0;
+
+    for (i = 0; i < n; i++) {
+        base[i] = 0;
+    }
+    while (len > 1) {
+        size_t half = len / 2;
+        for (i = 0; i < n; i++) {
+            STL_PREFETCH(array_slot(self, base[i] + half / 2));
+            STL_PREFETCH(array_slot(self, base[i] + half + half / 2));
+        }
+        for (i = 0; i < n; i++) {
+            base[i] = cmp(array_elem(self, base[i] + half), keys[i]) < 0 ? base[i] + half : base[i];
+        }
+        len -= half;
+    }
+    for (i = 0; i < n; i++) {
+        results[i] = base[i] + (len == 1 && cmp(array_elem(self, base[i]), keys[i]) < 0);
+    }
+}
+
+// Store the lower bound of each key in results
+int array_lower_bound_batch(Array *self, void **keys, size_t n, DataCompareFunc cmp, size_t *results) {
+    size_t i = 0;
+    return_val_if_fail(self != NULL && (keys != NULL || n == 0) && cmp != NULL && (results != NULL || n == 0), ERR_NIL);
+
+    if (self->size < ARRAY_SEARCH_INTERLEAVE_MIN) {
+        for (i = 0; i < n; i++) {
+            results[i] = array_bound(self, 0, self->size, keys[i], cmp, FALSE);
+        }
+        return OK;
+    }
+    for (i = 0; i < n; i += ARRAY_SEARCH_INTERLEAVE) {
+        size_t count = n - i < ARRAY_SEARCH_INTERLEAVE ? n - i : ARRAY_SEARCH_INTERLEAVE;
+        array_bound_interleaved(self, keys + i, count, cmp, results + i);
+    }
+    return OK;
+}
+
+// Store the lower bound of each of the sorted keys in results
+int array_lower_bound_batch_sorted(Array *self, void **keys, size_t n, DataCompareFunc cmp, size_t *results) {
+    size_t i = 0;
+    size_t low = 0;
+    return_val_if_fail(self != NULL && (keys != NULL || n == 0) && cmp != NULL && (results != NULL || n == 0), ERR_NIL);
+
+    // Everything before the previous result orders before this key, so the search resumes there,
+    // probing 1, 2, 4, ... elements ahead until an element does not order before the key
+    for (i = 0; i < n; i++) {
+        size_t high = low;
+        size_t step = 1;
+        while (high < self->size && cmp(array_elem(self, high), keys[i]) < 0) {
+            low = high + 1;
+            high = low + step - 1;
+            step <<= 1;
+        }
+        high = high < self->size ? high : self->size;
+        low += array_bound(self, low, high - low, keys[i], cmp, FALSE);
+        results[i] = low;
+    }
+    return OK;
+}
+
+// Sort the data in the array by an unsigned key
+int array_radix_sort(Array *self, ArrayKeyFunc key, void *ctx) {
+    return_val_if_fail(self != NULL && key != NULL, ERR_NIL);
+    void **view = array_sort_view(self);
+    if (view == NULL) {
+        return ERR_OOM;
+    }
+    return array_sort_apply(self, view, radix_sort_ptr(view, self->size, (SortKeyFunc)key, ctx));
+}
+
+// Sort the data in the array by a signed key
+int array_radix_sort_int64(Array *self, ArrayKeyInt64Func key, void *ctx) {
+    return_val_if_fail(self != NULL && key != NULL, ERR_NIL);
+    void **view = array_sort_view(self);
+    if (view == NULL) {
+        return ERR_OOM;
+    }
+    return array_sort_apply(self, view, radix_sort_ptr_int64(view, self->size, (SortKeyInt64Func)key, ctx));
+}
+
+// Sort the data in the array by a double key
+int array_radix_sort_double(Array *self, ArrayKeyDoubleFunc key, void *ctx) {
+    return_val_if_fail(self != NULL && key != NULL, ERR_NIL);
+    void **view = array_sort_view(self);
+    if (view == NULL) {
+        return ERR_OOM;
+    }
+    return array_sort_apply(self, view, radix_sort_ptr_double(view, self->size, (SortKeyDoubleFunc)key, ctx));
+}
+
 // Destroy the dynamic array and release resources
 void array_destroy(Array *self) {
     size_t i = 0;
 
     if (self != NULL) {
         for (i = 0; i < self->size; i++) {
-            array_destroy_data(self, self->data[i]);
+            array_destroy_data(self, array_elem(self, i));
         }
         STL_FREE(self->data);
         STL_FREE(self);
@@ -1,10 +1,14 @@
+#include <stdint.h>
 #include <stdio.h>
 #include "typedef.h"
 
 #ifndef ARRAY_H
 #define ARRAY_H
 
-// Define the structure for a dynamic array
+// Define the structure for a dynamic array.
+// By default the array stores pointers. An array made by array_create_inline stores elements of elem_size bytes
+// contiguously in data instead, and every function passing an element on, to callbacks or to the caller, passes
+// its address in the array.
 typedef struct {
     void **data;
     size_t size;
@@ -12,11 +16,25 @@ typedef struct {
 
     void *data_destroy_ctx;
     DataDestroyFunc data_destroy;
+
+    size_t elem_size;   // Size of an inline element in bytes, 0 for an array of pointers
 } Array;
 
+// Function pointer types for extracting the key array_radix_sort sorts an element by
+typedef uint64_t (*ArrayKeyFunc)(void* ctx, void* data);
+typedef int64_t (*ArrayKeyInt64Func)(void* ctx, void* data);
+typedef double (*ArrayKeyDoubleFunc)(void* ctx, void* data);
+
 // Create a new dynamic array
 Array* array_create(DataDestroyFunc data_destroy, void* ctx);
 
+// Create a new dynamic array storing elements of elem_size bytes inline, with no allocation per element.
+// Inserting or setting data copies elem_size bytes from it, so data must not be NULL, though it may be an element
+// of the same array. data_destroy, if any, gets the address of an element being removed, to release what the
+// element owns. array_sort sorts inline elements in place; the other sorts order a temporary array of pointers
+// to them, then copy them into that order.
+Array* array_create_inline(size_t elem_size, DataDestroyFunc data_destroy, void* ctx);
+
 // Insert data at the specified index
 int array_insert(Array* self, size_t index, void* data);
 
@@ -29,12 +47,20 @@ int array_append(Array* self, void* data);
 // Delete data at the specified index
 int array_delete(Array* self, size_t index);
 
+// Resize the array to size elements, destroying the ones cut off and filling new slots with NULL
+// (or, for inline elements, with zero bytes)
+int array_resize(Array* self, size_t size);
+
 // Get data by index
 int array_get_by_index(Array* self, size_t index, void** data);
 
 // Set data at the specified index
 int array_set_by_index(Array* self, size_t index, void* data);
 
+// Get the element at index, or NULL if index is out of range. For inline elements this is the element's address,
+// valid until the array is next resized.
+void* array_at(Array* self, size_t index);
+
 // Get the length of the array
 size_t array_length(Array* self);
 
@@ -44,9 +70,61 @@ int array_find(Array* self, DataCompareFunc cmp, void* ctx);
 // Apply a visiting function to the data in the array
 int array_foreach(Array* self, DataVisitFunc visit, void* ctx);
 
-// Sort the data in the array
+// Sort the data in the array.
+// The elements are reordered in place, inline elements by swapping their bytes; swp is kept for compatibility
+// and may be NULL.
 int array_sort(Array* self, DataCompareFunc cmp, DataSwapFunc swp);
 
+// Sort the data in the array, keeping equal elements in their original order.
+// Takes close to n comparisons on input made of a few sorted runs; uses up to n / 2 extra pointers.
+int array_sort_stable(Array* self, DataCompareFunc cmp);
+
+// Reorder the data so that the element at nth is the one array_sort would put there, every element
+// before it comparing less or equal and every element after it greater or equal. Expected O(n).
+int array_nth_element(Array* self, size_t nth, DataCompareFunc cmp);
+
+// Move the k smallest elements, sorted as array_sort would, to the front of the array; the rest keep
+// no particular order. O(n log k) for small k instead of a full sort's O(n log n).
+int array_partial_sort(Array* self, size_t k, DataCompareFunc cmp);
+
+// Store the k smallest elements, sorted as array_sort would, in dest, reading the array once with a bounded heap
+// and leaving it unchanged. dest is resized to hold min(k, length) elements first, destroying those it held;
+// it shares the elements with self, so it should not destroy them itself. O(n log k) time and no memory beyond dest.
+// dest must store elements the same way as self; inline elements are copied to it.
+int array_top_k(Array* self, size_t k, DataCompareFunc cmp, Array* dest);
+
+// Get the index of the first element of a sorted array that does not order before data, or the length if
+// every element does. cmp is called like array_sort's, as cmp(element, data). The search has no data-dependent
+// branches and prefetches both candidate midpoints of the next step.
+size_t array_lower_bound(Array* self, void* data, DataCompareFunc cmp);
+
+// Get the index of the first element of a sorted array that orders after data, or the length if none does
+size_t array_upper_bound(Array* self, void* data, DataCompareFunc cmp);
+
+// Get the range [first, last) of the elements of a sorted array that order neither before nor after data
+int array_equal_range(Array* self, void* data, DataCompareFunc cmp, size_t* first, size_t* last);
+
+// Store in results[i] the lower bound of keys[i], for n keys in any order. cmp is only called as cmp(element, key).
+// On arrays too large for the cache, groups of keys are searched in lockstep so that their cache misses overlap.
+int array_lower_bound_batch(Array* self, void** keys, size_t n, DataCompareFunc cmp, size_t* results);
+
+// Store in results[i] the lower bound of keys[i], for n keys the caller has sorted in the array's order; with
+// unsorted keys the results are unspecified. Each search gallops forward from the previous result, touching
+// O(n log(length / n)) elements in one sweep over the array. cmp is only called as cmp(element, key).
+int array_lower_bound_batch_sorted(Array* self, void** keys, size_t n, DataCompareFunc cmp, size_t* results);
+
+// Sort the data in the array by the unsigned key returned by key, keeping equal keys in their original order.
+// An LSD radix sort: key is called once per element, and digits that are the same in every key cost nothing.
+// Uses 32 bytes per element of temporary memory; returns ERR_OOM, leaving the array as it was, without it.
+int array_radix_sort(Array* self, ArrayKeyFunc key, void* ctx);
+
+// Sort the data in the array by a signed key, like array_radix_sort
+int array_radix_sort_int64(Array* self, ArrayKeyInt64Func key, void* ctx);
+
+// Sort the data in the array by a double key, like array_radix_sort.
+// -0.0 sorts before 0.0 and NaNs sort after +infinity, or before -infinity when their sign bit is set.
+int array_radix_sort_double(Array* self, ArrayKeyDoubleFunc key, void* ctx);
+
 // Destroy the dynamic array and release resources
 void array_destroy(Array* self);
 
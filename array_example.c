@@ -8,22 +8,6 @@ int data_cmp(void *i, void *j) {
     return *(int*)i - *(int*)j;
 }
 
-// Swap function for sorting
-int data_swap(void *arr, size_t i, size_t j) {
-    void *i_ptr = NULL;
-    void *j_ptr = NULL;
-
-    // Get elements at indices i and j
-    array_get_by_index(arr, i, &i_ptr);
-    array_get_by_index(arr, j, &j_ptr);
-
-    // Swap the elements
-    void *temp = i_ptr;
-    array_set_by_index(arr, i, j_ptr);
-    array_set_by_index(arr, j, temp);
-    return OK;
-}
-
 // Function to destroy data during array destruction
 void data_destroy(void* ctx, void* data) {
     STL_FREE(data);
@@ -55,8 +39,8 @@ int main() {
     // Traverse and print the array before sorting
     array_foreach(array, data_visit, NULL);
 
-    // Sort the array using the defined comparison and swap functions
-    array_sort(array, data_cmp, data_swap);
+    // Sort the array using the defined comparison function
+    array_sort(array, data_cmp, NULL);
 
     // Destroy the array, freeing allocated memory
     array_destroy(array);
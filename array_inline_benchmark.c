@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "array.h"
+
+// Comparison function for sorting
+int data_cmp(void *i, void *j) {
+    int a = *(int*)i;
+    int b = *(int*)j;
+    return (a > b) - (a < b);
+}
+
+// Function to destroy data during array destruction
+void data_destroy(void* ctx, void* data) {
+    STL_FREE(data);
+}
+
+// Visit function summing the elements into ctx
+BOOL data_sum(void* ctx, size_t index, void* data) {
+    *(long long*)ctx += *(int*)data;
+    return TRUE;
+}
+
+// Structure holding the measurements of one array mode
+typedef struct {
+    double mb;          // Resident memory the filled array added
+    double append_ms;
+    double scan_ms;
+    double sort_ms;
+    double search_ms;
+} Result;
+
+// Function to get the current monotonic time in milliseconds
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// Function to get the resident memory of the process in megabytes, or a negative value where /proc is missing
+static double resident_mb(void) {
+    long pages = -1;
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file != NULL) {
+        if (fscanf(file, "%*s %ld", &pages) != 1) {
+            pages = -1;
+        }
+        fclose(file);
+    }
+    return pages < 0 ? -1.0 : (double)pages * 4096.0 / (1024.0 * 1024.0);
+}
+
+// Function to fill, scan, sort and search n ints stored as pointers or, with inline set, inline
+static Result bench(size_t n, BOOL inline_elems) {
+    Result result;
+    long long sum = 0;
+    size_t found = 0;
+
+    srand(42);
+    double before = resident_mb();
+    double start = now_ms();
+    Array *array = inline_elems ? array_create_inline(sizeof(int), NULL, NULL) : array_create(data_destroy, NULL);
+    for (size_t i = 0; i < n; i++) {
+        int value = rand();
+        if (inline_elems) {
+            array_append(array, &value);
+        } else {
+            int *data = (int*) STL_MALLOC(sizeof(int));
+            *data = value;
+            array_append(array, data);
+        }
+    }
+    result.append_ms = now_ms() - start;
+    result.mb = before < 0 ? -1.0 : resident_mb() - before;
+
+    start = now_ms();
+    for (int round = 0; round < 10; round++) {
+        array_foreach(array, data_sum, &sum);
+    }
+    result.scan_ms = (now_ms() - start) / 10;
+
+    start = now_ms();
+    array_sort(array, data_cmp, NULL);
+    result.sort_ms = now_ms() - start;
+
+    start = now_ms();
+    for (size_t i = 0; i < n; i++) {
+        int key = rand();
+        found += array_lower_bound(array, &key, data_cmp) < n;
+    }
+    result.search_ms = now_ms() - start;
+
+    for (size_t i = 1; i < n; i++) {
+        if (data_cmp(array_at(array, i - 1), array_at(array, i)) > 0) {
+            printf("%s: output is not sorted\n", inline_elems ? "inline" : "pointer");
+            break;
+        }
+    }
+    if (sum == 0 && found == 0) {
+        printf("unexpected empty result\n");
+    }
+    array_destroy(array);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    // The inline array runs first: the pointer array leaves its freed elements in the heap, where the inline
+    // array's buffer would be carved from without raising the resident size
+    Result results[2];
+    results[1] = bench(n, TRUE);
+    results[0] = bench(n, FALSE);
+
+    printf("%zu ints\n", n);
+    printf("%-8s %10s %12s %10s %10s %12s\n", "mode", "memory(MB)", "append(ms)", "scan(ms)", "sort(ms)", "search(ms)");
+    for (int i = 0; i < 2; i++) {
+        printf("%-8s %10.1f %12.2f %10.2f %10.2f %12.2f\n", i == 0 ? "pointer" : "inline", results[i].mb,
+               results[i].append_ms, results[i].scan_ms, results[i].sort_ms, results[i].search_ms);
+    }
+    printf("%-8s %9.1fx %11.1fx %9.1fx %9.1fx %11.1fx\n", "gain", results[0].mb / results[1].mb,
+           results[0].append_ms / results[1].append_ms, results[0].scan_ms / results[1].scan_ms,
+           results[0].sort_ms / results[1].sort_ms, results[0].search_ms / results[1].search_ms);
+    return 0;
+}
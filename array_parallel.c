@@ -0,0 +1,324 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include "array_parallel.h"
+#include "sort.h"
+
+// Merges of at most this many elements run serially
+#define ARRAY_SORT_PARALLEL_MERGE_CUTOFF 8192
+
+// Kinds of work a parallel range task does on its elements
+typedef enum {
+    ARRAY_PARALLEL_FOREACH = 0,
+    ARRAY_PARALLEL_MAP,
+    ARRAY_PARALLEL_REDUCE,
+} ArrayParallelKind;
+
+// Structure representing what every range task of one call shares
+typedef struct {
+    ArrayParallelKind kind;
+    void** data;                // Source elements
+    size_t elem_size;           // Size of an inline source element, 0 for pointers
+    void** dest;                // Destination elements for map
+    size_t grain;               // Ranges at most this long are processed without splitting
+    DataVisitFunc visit;
+    ArrayMapFunc map;
+    ArrayReduceFunc reduce;
+    ArrayCombineFunc combine;
+    void* init;                 // Accumulator each reduce chunk starts from
+    void* ctx;                  // Context passed to the user functions
+    atomic_size_t stop;         // Lowest index whose visit returned FALSE, SIZE_MAX until then
+} ArrayParallelJob;
+
+// Structure representing the range [low, high) of a job and, for reduce, its accumulator
+typedef struct {
+    ArrayParallelJob* job;
+    size_t low;
+    size_t high;
+    void* acc;
+} ArrayParallelRange;
+
+// Function to get source element i as the user functions see it, the stored pointer or the address of an inline element
+static inline void* array_parallel_elem(ArrayParallelJob* job, size_t i) {
+    return job->elem_size == 0 ? job->data[i] : (void*)((char*)job->data + i * job->elem_size);
+}
+
+// Function to process a range no longer than the grain on the calling thread
+static void array_parallel_leaf(ArrayParallelRange* range) {
+    ArrayParallelJob* job = range->job;
+    size_t i = 0;
+
+    switch (job->kind) {
+        case ARRAY_PARALLEL_FOREACH:
+            for (i = range->low; i < range->high; i++) {
+                // A stop at a lower index makes the rest of this range unnecessary
+                if (i > atomic_load_explicit(&job->stop, memory_order_relaxed)) {
+                    break;
+                }
+                if (!job->visit(job->ctx, i, array_parallel_elem(job, i))) {
+                    size_t stop = atomic_load_explicit(&job->stop, memory_order_relaxed);
+                    while (i < stop && !atomic_compare_exchange_weak_explicit(&job->stop, &stop, i,
+                                                                              memory_order_relaxed,
+                                                                              memory_order_relaxed)) {
+                    }
+                    break;
+                }
+            }
+            break;
+        case ARRAY_PARALLEL_MAP:
+            for (i = range->low; i < range->high; i++) {
+                job->dest[i] = job->map(job->ctx, i, array_parallel_elem(job, i));
+            }
+            break;
+        case ARRAY_PARALLEL_REDUCE:
+            range->acc = job->init;
+            for (i = range->low; i < range->high; i++) {
+                range->acc = job->reduce(job->ctx, range->acc, i, array_parallel_elem(job, i));
+            }
+            break;
+    }
+}
+
+// Function to process a range, splitting it in halves and spawning the right half until it fits the grain
+static void array_parallel_task(void* arg) {
+    ArrayParallelRange* range = (ArrayParallelRange*)arg;
+    ArrayParallelJob* job = range->job;
+
+    if (job->kind == ARRAY_PARALLEL_FOREACH && range->low > atomic_load_explicit(&job->stop, memory_order_relaxed)) {
+        return;
+    }
+    if (range->high - range->low <= job->grain) {
+        array_parallel_leaf(range);
+        return;
+    }
+
+    size_t mid = range->low + (range->high - range->low) / 2;
+    ArrayParallelRange left = {job, range->low, mid, NULL};
+    ArrayParallelRange right = {job, mid, range->high, NULL};
+    SchedulerTask task;
+    // The left half runs here first, so a serial schedule visits elements in order
+    scheduler_spawn(&task, array_parallel_task, &right);
+    array_parallel_task(&left);
+    scheduler_join(&task);
+    if (job->kind == ARRAY_PARALLEL_REDUCE) {
+        range->acc = job->combine(job->ctx, left.acc, right.acc);
+    }
+}
+
+// Function to run a job over [0, n) on the scheduler, or on the calling thread without one
+static void array_parallel_run(Scheduler* scheduler, ArrayParallelJob* job, size_t n, ArrayParallelRange* range) {
+    if (job->grain == 0) {
+        size_t chunks = scheduler != NULL ? scheduler_thread_n(scheduler) * ARRAY_PARALLEL_CHUNKS : 1;
+        job->grain = n / chunks > 0 ? n / chunks : 1;
+    }
+    range->job = job;
+    range->low = 0;
+    range->high = n;
+    range->acc = job->init;
+    if (n == 0) {
+        return;
+    }
+    if (scheduler == NULL) {
+        array_parallel_task(range);
+    } else {
+        scheduler_run(scheduler, array_parallel_task, range);
+    }
+}
+
+// Function to fill in the fields shared by every kind of job
+static void array_parallel_job_init(ArrayParallelJob* job, ArrayParallelKind kind, Array* self, size_t grain, void* ctx) {
+    job->kind = kind;
+    job->data = self->data;
+    job->elem_size = self->elem_size;
+    job->dest = NULL;
+    job->grain = grain;
+    job->visit = NULL;
+    job->map = NULL;
+    job->reduce = NULL;
+    job->combine = NULL;
+    job->init = NULL;
+    job->ctx = ctx;
+    atomic_init(&job->stop, SIZE_MAX);
+}
+
+// Visit every element on the scheduler's workers, in chunks of grain elements (0 picks a grain)
+int array_parallel_foreach(Scheduler* scheduler, Array* self, DataVisitFunc visit, void* ctx, size_t grain) {
+    return_val_if_fail(self != NULL && visit != NULL, ERR_NIL);
+    ArrayParallelJob job;
+    ArrayParallelRange range;
+
+    array_parallel_job_init(&job, ARRAY_PARALLEL_FOREACH, self, grain, ctx);
+    job.visit = visit;
+    array_parallel_run(scheduler, &job, self->size, &range);
+    return OK;
+}
+
+// Store map(ctx, i, self[i]) at index i of dest, on the scheduler's workers
+int array_parallel_map(Scheduler* scheduler, Array* self, Array* dest, ArrayMapFunc map, void* ctx, size_t grain) {
+    return_val_if_fail(self != NULL && dest != NULL && map != NULL && dest->elem_size == 0, ERR_NIL);
+    ArrayParallelJob job;
+    ArrayParallelRange range;
+
+    if (dest != self && array_resize(dest, 0) != OK) {
+        return ERR_NIL;
+    }
+    if (array_resize(dest, self->size) != OK) {
+        return ERR_OOM;
+    }
+    array_parallel_job_init(&job, ARRAY_PARALLEL_MAP, self, grain, ctx);
+    job.dest = dest->data;
+    job.map = map;
+    array_parallel_run(scheduler, &job, self->size, &range);
+    return OK;
+}
+
+// Fold the elements into result on the scheduler's workers
+int array_parallel_reduce(Scheduler* scheduler, Array* self, void* init, ArrayReduceFunc reduce,
+                          ArrayCombineFunc combine, void* ctx, size_t grain, void** result) {
+    return_val_if_fail(self != NULL && reduce != NULL && combine != NULL && result != NULL, ERR_NIL);
+    ArrayParallelJob job;
+    ArrayParallelRange range;
+
+    array_parallel_job_init(&job, ARRAY_PARALLEL_REDUCE, self, grain, ctx);
+    job.reduce = reduce;
+    job.combine = combine;
+    job.init = init;
+    array_parallel_run(scheduler, &job, self->size, &range);
+    *result = range.acc;
+    return OK;
+}
+
+// Structure representing one merge of the sorted runs left[0, left_n) and right[0, right_n) into out
+typedef struct {
+    void** left;
+    size_t left_n;
+    void** right;
+    size_t right_n;
+    void** out;
+    SortCmpFunc cmp;
+} ArraySortMerge;
+
+// Structure representing one sort of src[0, n), leaving the result in dst when to_dst is set, else in src
+typedef struct {
+    void** src;
+    void** dst;
+    size_t n;
+    BOOL to_dst;
+    size_t cutoff;
+    SortCmpFunc cmp;
+} ArraySortRange;
+
+// Function to merge two sorted runs serially. Ties take the left run first.
+static void array_sort_merge_serial(ArraySortMerge* merge) {
+    void** left = merge->left;
+    void** left_end = left + merge->left_n;
+    void** right = merge->right;
+    void** right_end = right + merge->right_n;
+    void** out = merge->out;
+
+    while (left < left_end && right < right_end) {
+        if (merge->cmp(*right, *left) < 0) {
+            *out++ = *right++;
+        } else {
+            *out++ = *left++;
+        }
+    }
+    memcpy(out, left, (size_t)(left_end - left) * sizeof(void*));
+    out += left_end - left;
+    memcpy(out, right, (size_t)(right_end - right) * sizeof(void*));
+}
+
+// Function to find the first position of a sorted run whose element is not less than key (right is FALSE),
+// or greater than key (right is TRUE)
+static size_t array_sort_search(void** data, size_t n, void* key, BOOL right, SortCmpFunc cmp) {
+    size_t low = 0;
+    size_t high = n;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int c = cmp(data[mid], key);
+        if (c < 0 || (right && c == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Function to merge two sorted runs, splitting the merge at the median of the longer run
+// and merging both sides in parallel until the pieces are small
+static void array_sort_merge_task(void* arg) {
+    ArraySortMerge* merge = (ArraySortMerge*)arg;
+    if (merge->left_n + merge->right_n <= ARRAY_SORT_PARALLEL_MERGE_CUTOFF
+        || merge->left_n == 0 || merge->right_n == 0) {
+        array_sort_merge_serial(merge);
+        return;
+    }
+
+    // Elements equal to the split key stay on the left side when it comes from the left run
+    // and on the right side otherwise, so ties keep taking the left run first
+    size_t left_mid, right_mid;
+    if (merge->left_n >= merge->right_n) {
+        left_mid = merge->left_n / 2;
+        right_mid = array_sort_search(merge->right, merge->right_n, merge->left[left_mid], FALSE, merge->cmp);
+    } else {
+        right_mid = merge->right_n / 2;
+        left_mid = array_sort_search(merge->left, merge->left_n, merge->right[right_mid], TRUE, merge->cmp);
+    }
+
+    ArraySortMerge low = {merge->left, left_mid, merge->right, right_mid, merge->out, merge->cmp};
+    ArraySortMerge high = {merge->left + left_mid, merge->left_n - left_mid, merge->right + right_mid,
+                           merge->right_n - right_mid, merge->out + left_mid + right_mid, merge->cmp};
+    SchedulerTask task;
+    scheduler_spawn(&task, array_sort_merge_task, &high);
+    array_sort_merge_task(&low);
+    scheduler_join(&task);
+}
+
+// Function to sort a range: small ranges with the introsort, larger ones by sorting both halves
+// into the other buffer in parallel and merging them back
+static void array_sort_task(void* arg) {
+    ArraySortRange* range = (ArraySortRange*)arg;
+    if (range->n <= range->cutoff) {
+        quick_sort_ptr(range->src, range->n, range->cmp);
+        if (range->to_dst) {
+            memcpy(range->dst, range->src, range->n * sizeof(void*));
+        }
+        return;
+    }
+
+    // Buffers alternate level by level, so each merge reads one buffer and writes the other
+    size_t half = range->n / 2;
+    ArraySortRange left = {range->src, range->dst, half, !range->to_dst, range->cutoff, range->cmp};
+    ArraySortRange right = {range->src + half, range->dst + half, range->n - half, !range->to_dst,
+                            range->cutoff, range->cmp};
+    SchedulerTask task;
+    scheduler_spawn(&task, array_sort_task, &right);
+    array_sort_task(&left);
+    scheduler_join(&task);
+
+    void** from = range->to_dst ? range->src : range->dst;
+    void** to = range->to_dst ? range->dst : range->src;
+    ArraySortMerge merge = {from, half, from + half, range->n - half, to, range->cmp};
+    array_sort_merge_task(&merge);
+}
+
+// Sort the array on the scheduler's workers with a parallel merge sort, calling cmp like array_sort does
+int array_sort_parallel(Scheduler* scheduler, Array* self, DataCompareFunc cmp, size_t cutoff) {
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+    size_t n = self->size;
+
+    if (cutoff == 0) {
+        size_t chunks = scheduler != NULL ? scheduler_thread_n(scheduler) * ARRAY_SORT_PARALLEL_CHUNKS : 1;
+        cutoff = n / chunks > ARRAY_SORT_PARALLEL_MIN_CUTOFF ? n / chunks : ARRAY_SORT_PARALLEL_MIN_CUTOFF;
+    }
+    void** buffer = NULL;
+    if (self->elem_size != 0 || scheduler == NULL || n <= cutoff || (buffer = (void**)STL_MALLOC(n * sizeof(void*))) == NULL) {
+        return array_sort(self, cmp, NULL);
+    }
+
+    ArraySortRange range = {self->data, buffer, n, FALSE, cutoff, (SortCmpFunc)cmp};
+    scheduler_run(scheduler, array_sort_task, &range);
+    STL_FREE(buffer);
+    return OK;
+}
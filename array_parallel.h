@@ -0,0 +1,53 @@
+#ifndef ARRAY_PARALLEL_H
+#define ARRAY_PARALLEL_H
+
+#include <stdio.h>
+#include "typedef.h"
+#include "array.h"
+#include "scheduler.h"
+
+// Number of chunks per worker picked when a grain of 0 is passed; more chunks than workers
+// let work stealing even out elements that take different times to process
+#define ARRAY_PARALLEL_CHUNKS 8
+
+// Function pointer type for mapping the element at index to the element stored at the same index of the destination
+typedef void* (*ArrayMapFunc)(void* ctx, size_t index, void* data);
+
+// Function pointer type for folding the element at index into an accumulator, returning the new accumulator
+typedef void* (*ArrayReduceFunc)(void* ctx, void* acc, size_t index, void* data);
+
+// Function pointer type for combining the accumulators of two adjacent ranges, left before right
+typedef void* (*ArrayCombineFunc)(void* ctx, void* left, void* right);
+
+// Visit every element on the scheduler's workers, in chunks of grain elements (0 picks a grain).
+// visit runs concurrently and in no particular order. Returning FALSE stops the traversal the way it
+// stops array_foreach: every element before the lowest index whose visit returned FALSE is still visited,
+// chunks past it are skipped, and elements after it may or may not be visited.
+// A NULL scheduler runs the traversal on the calling thread.
+int array_parallel_foreach(Scheduler* scheduler, Array* self, DataVisitFunc visit, void* ctx, size_t grain);
+
+// Store map(ctx, i, self[i]) at index i of dest, on the scheduler's workers. dest is resized to the length
+// of self first, destroying the elements it held; it may be self, to replace the elements in place.
+// dest must store pointers, since map returns one; self may store inline elements.
+int array_parallel_map(Scheduler* scheduler, Array* self, Array* dest, ArrayMapFunc map, void* ctx, size_t grain);
+
+// Fold the elements into result on the scheduler's workers. Each chunk folds its elements into init with
+// reduce, from left to right, and adjacent chunks are merged with combine, left before right.
+// init must be an identity for combine and combine must be associative; it need not be commutative.
+int array_parallel_reduce(Scheduler* scheduler, Array* self, void* init, ArrayReduceFunc reduce,
+                          ArrayCombineFunc combine, void* ctx, size_t grain, void** result);
+
+// Number of leaf ranges per worker picked when array_sort_parallel is given a cutoff of 0
+#define ARRAY_SORT_PARALLEL_CHUNKS 4
+
+// Smallest cutoff array_sort_parallel picks; below it spawning costs more than the parallelism gains
+#define ARRAY_SORT_PARALLEL_MIN_CUTOFF 4096
+
+// Sort the array on the scheduler's workers with a parallel merge sort, calling cmp like array_sort does.
+// Ranges of at most cutoff elements (0 picks one) are sorted by array_sort's introsort and then merged
+// pairwise, large merges being split in parallel too. Needs a buffer of one pointer per element;
+// without the memory for it, or with a NULL scheduler, it sorts on the calling thread like array_sort.
+// Arrays of inline elements are always sorted on the calling thread by array_sort.
+int array_sort_parallel(Scheduler* scheduler, Array* self, DataCompareFunc cmp, size_t cutoff);
+
+#endif /*ARRAY_PARALLEL_H*/
@@ -0,0 +1,96 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "array_parallel.h"
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to mix the bits of a value a few times, standing in for a CPU-bound per-element transform
+static inline uintptr_t transform(uintptr_t x) {
+    for (int i = 0; i < 8; i++) {
+        x ^= x >> 31;
+        x *= 0x7fb5d329728ea185ULL;
+        x ^= x >> 27;
+    }
+    return x;
+}
+
+// Map function applying the transform
+void *data_map(void *ctx, size_t index, void *data) {
+    return (void*)transform((uintptr_t)data);
+}
+
+// Visit function applying the transform and storing the result in ctx, an array of n slots
+BOOL data_visit(void *ctx, size_t index, void *data) {
+    ((uintptr_t*)ctx)[index] = transform((uintptr_t)data);
+    return TRUE;
+}
+
+// Reduce function adding an element to the accumulator
+void *data_sum(void *ctx, void *acc, size_t index, void *data) {
+    return (void*)((uintptr_t)acc + (uintptr_t)data);
+}
+
+// Combine function adding two accumulators
+void *data_combine(void *ctx, void *left, void *right) {
+    return (void*)((uintptr_t)left + (uintptr_t)right);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : 8;
+    Array *array = array_create(NULL, NULL);
+    Array *dest = array_create(NULL, NULL);
+    uintptr_t *out = (uintptr_t*)malloc(n * sizeof(uintptr_t));
+    for (size_t i = 0; i < n; i++) {
+        array_append(array, (void*)(uintptr_t)(i + 1));
+    }
+
+    double start = now_ns();
+    array_foreach(array, data_visit, out);
+    double foreach_ms = (now_ns() - start) / 1e6;
+    start = now_ns();
+    uintptr_t expect = 0;
+    for (size_t i = 0; i < n; i++) {
+        expect += (uintptr_t)array->data[i];
+    }
+    double sum_ms = (now_ns() - start) / 1e6;
+
+    printf("%zu elements, ms per pass (grain 0 picks %d chunks per worker)\n", n, ARRAY_PARALLEL_CHUNKS);
+    printf("%-10s %8s %12s %12s %12s %8s\n", "threads", "grain", "foreach", "map", "reduce", "check");
+    printf("%-10s %8s %12.1f %12s %12.1f %8s\n", "serial", "-", foreach_ms, "-", sum_ms, "-");
+
+    size_t grains[] = {0, 1024, 64};
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        Scheduler *scheduler = scheduler_create(threads);
+        for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); g++) {
+            void *sum = NULL;
+
+            start = now_ns();
+            array_parallel_foreach(scheduler, array, data_visit, out, grains[g]);
+            double pforeach_ms = (now_ns() - start) / 1e6;
+            start = now_ns();
+            array_parallel_map(scheduler, array, dest, data_map, NULL, grains[g]);
+            double pmap_ms = (now_ns() - start) / 1e6;
+            start = now_ns();
+            array_parallel_reduce(scheduler, array, NULL, data_sum, data_combine, NULL, grains[g], &sum);
+            double preduce_ms = (now_ns() - start) / 1e6;
+
+            BOOL ok = (uintptr_t)sum == expect && (uintptr_t)dest->data[n - 1] == out[n - 1];
+            printf("%-10zu %8zu %12.1f %12.1f %12.1f %8s\n", threads, grains[g], pforeach_ms, pmap_ms, preduce_ms,
+                   ok ? "ok" : "MISMATCH");
+        }
+        scheduler_destroy(scheduler);
+    }
+
+    free(out);
+    array_destroy(dest);
+    array_destroy(array);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include "blocking_queue.h"
+
+// Number of times a consumer finding the queue empty yields the CPU before going to sleep.
+// A producer mid-burst usually refills the queue meanwhile, which saves a sleep and a wake-up.
+#define BLOCKING_QUEUE_YIELDS 2
+
+// Function to create a new blocking queue
+BlockingQueue* blocking_queue_create(DataDestroyFunc data_destroy, void* ctx) {
+    BlockingQueue* self = (BlockingQueue*)STL_MALLOC(sizeof(BlockingQueue));
+    pthread_condattr_t attr;
+
+    if (self != NULL) {
+        if ((self->queue = queue_create(data_destroy, ctx)) == NULL) {
+            STL_FREE(self);
+            return NULL;
+        }
+        // Timeouts are measured on the monotonic clock so wall clock changes do not stretch them;
+        // a condition variable on another clock would get the deadlines wrong, so failing to set it fails
+        int ret = pthread_condattr_init(&attr);
+        if (ret == 0) {
+            if ((ret = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC)) == 0) {
+                ret = pthread_cond_init(&self->not_empty, &attr);
+            }
+            pthread_condattr_destroy(&attr);
+        }
+        if (ret == 0 && (ret = pthread_mutex_init(&self->lock, NULL)) != 0) {
+            pthread_cond_destroy(&self->not_empty);
+        }
+        if (ret != 0) {
+            queue_destroy(self->queue);
+            STL_FREE(self);
+            return NULL;
+        }
+        self->sleepers = 0;
+        self->wakeups = 0;
+        self->closed = FALSE;
+    }
+    return self;
+}
+
+// Function to wake one more sleeping consumer when the queue holds work that the consumers
+// already being woken will not take. Called with the lock held.
+static void blocking_queue_wake(BlockingQueue* self) {
+    if (self->sleepers > self->wakeups && queue_length(self->queue) > self->wakeups) {
+        self->wakeups++;
+        pthread_cond_signal(&self->not_empty);
+    }
+}
+
+// Function to push an element to the end of the queue
+int blocking_queue_push(BlockingQueue* self, void* data) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    int ret = ERR_NIL;
+
+    pthread_mutex_lock(&self->lock);
+    if (!self->closed && (ret = queue_push(self->queue, data)) == OK) {
+        blocking_queue_wake(self);
+    }
+    pthread_mutex_unlock(&self->lock);
+    return ret;
+}
+
+// Function to push n elements to the end of the queue, in order
+int blocking_queue_push_n(BlockingQueue* self, void** data, size_t n) {
+    return_val_if_fail(self != NULL && (data != NULL || n == 0), ERR_NIL);
+    int ret = ERR_NIL;
+
+    pthread_mutex_lock(&self->lock);
+    // One consumer is woken here; it wakes the next one itself if work is left after its pop
+    if (!self->closed && (ret = queue_push_n(self->queue, data, n)) == OK) {
+        blocking_queue_wake(self);
+    }
+    pthread_mutex_unlock(&self->lock);
+    return ret;
+}
+
+// Function to wait until the queue has an element, is closed, or the deadline passes. Called with the lock held.
+static int blocking_queue_wait(BlockingQueue* self, long timeout_ms) {
+    struct timespec deadline;
+
+    if (timeout_ms > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    for (int yields = 0; queue_length(self->queue) == 0; yields++) {
+        if (self->closed) {
+            return ERR_NIL;
+        }
+        if (timeout_ms == 0) {
+            return ERR_TIMEOUT;
+        }
+        if (yields < BLOCKING_QUEUE_YIELDS) {
+            pthread_mutex_unlock(&self->lock);
+            sched_yield();
+            pthread_mutex_lock(&self->lock);
+            continue;
+        }
+
+        int rc;
+        self->sleepers++;
+        if (timeout_ms > 0) {
+            rc = pthread_cond_timedwait(&self->not_empty, &self->lock, &deadline);
+        } else {
+            rc = pthread_cond_wait(&self->not_empty, &self->lock);
+        }
+        self->sleepers--;
+        // Count this thread as woken whatever the reason: undercounting only costs a spare signal,
+        // overcounting would keep producers from waking the remaining sleepers
+        if (self->wakeups > 0) {
+            self->wakeups--;
+        }
+        if (self->wakeups > self->sleepers) {
+            self->wakeups = self->sleepers;
+        }
+        if (rc == ETIMEDOUT && queue_length(self->queue) == 0) {
+            return self->closed ? ERR_NIL : ERR_TIMEOUT;
+        }
+    }
+    return OK;
+}
+
+// Function to pop the head element, waiting up to timeout_ms milliseconds
+int blocking_queue_pop_wait(BlockingQueue* self, void** data, long timeout_ms) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+
+    pthread_mutex_lock(&self->lock);
+    int ret = blocking_queue_wait(self, timeout_ms);
+    if (ret == OK) {
+        queue_pop_n(self->queue, data, 1);
+        blocking_queue_wake(self);
+    }
+    pthread_mutex_unlock(&self->lock);
+    return ret;
+}
+
+// Function to pop up to max_n elements, waiting up to timeout_ms milliseconds for the first one
+size_t blocking_queue_pop_batch(BlockingQueue* self, void** data, size_t max_n, long timeout_ms) {
+    return_val_if_fail(self != NULL && data != NULL && max_n > 0, 0);
+    size_t n = 0;
+
+    pthread_mutex_lock(&self->lock);
+    if (blocking_queue_wait(self, timeout_ms) == OK) {
+        n = queue_pop_n(self->queue, data, max_n);
+        blocking_queue_wake(self);
+    }
+    pthread_mutex_unlock(&self->lock);
+    return n;
+}
+
+// Function to close the queue and wake every sleeping consumer
+int blocking_queue_close(BlockingQueue* self) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+
+    pthread_mutex_lock(&self->lock);
+    self->closed = TRUE;
+    self->wakeups = self->sleepers;
+    pthread_cond_broadcast(&self->not_empty);
+    pthread_mutex_unlock(&self->lock);
+    return OK;
+}
+
+// Function to get the current length (number of elements) in the queue
+size_t blocking_queue_length(BlockingQueue* self) {
+    return_val_if_fail(self != NULL, 0);
+
+    pthread_mutex_lock(&self->lock);
+    size_t size = queue_length(self->queue);
+    pthread_mutex_unlock(&self->lock);
+    return size;
+}
+
+// Function to destroy the queue and the elements left in it
+void blocking_queue_destroy(BlockingQueue* self) {
+    if (self != NULL) {
+        queue_destroy(self->queue);
+        pthread_cond_destroy(&self->not_empty);
+        pthread_mutex_destroy(&self->lock);
+        STL_FREE(self);
+    }
+}
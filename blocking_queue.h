@@ -0,0 +1,48 @@
+#ifndef BLOCKING_QUEUE_H
+#define BLOCKING_QUEUE_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "typedef.h"
+#include "queue.h"
+
+// Structure representing a Queue shared between threads, where consumers sleep until work arrives.
+// Producers only signal when a sleeping consumer is not already being woken, so a busy
+// queue with awake consumers costs no wake-up system calls.
+typedef struct {
+    Queue* queue;               // Underlying ring buffer queue
+    pthread_mutex_t lock;       // Protects every field
+    pthread_cond_t not_empty;   // Signalled when work arrives or the queue is closed
+    size_t sleepers;            // Consumers waiting on not_empty
+    size_t wakeups;             // Signals sent to sleepers that have not woken up yet
+    BOOL closed;                // Set by blocking_queue_close, no more pushes are accepted
+} BlockingQueue;
+
+// Function to create a new blocking queue
+BlockingQueue* blocking_queue_create(DataDestroyFunc data_destroy, void* ctx);
+
+// Function to push an element, waking a sleeping consumer only when none is already waking
+int blocking_queue_push(BlockingQueue* self, void* data);
+
+// Function to push n elements in order under one lock acquisition
+int blocking_queue_push_n(BlockingQueue* self, void** data, size_t n);
+
+// Function to pop the head element, waiting up to timeout_ms milliseconds (negative waits forever,
+// 0 does not wait). Returns ERR_TIMEOUT when the wait expires and ERR_NIL once the queue is
+// closed and drained. The popped element belongs to the caller.
+int blocking_queue_pop_wait(BlockingQueue* self, void** data, long timeout_ms);
+
+// Function to pop up to max_n elements into data, waiting like blocking_queue_pop_wait for the first one.
+// Returns how many were popped, 0 on timeout or once the queue is closed and drained.
+size_t blocking_queue_pop_batch(BlockingQueue* self, void** data, size_t max_n, long timeout_ms);
+
+// Function to close the queue: pushes fail from now on and consumers drain what is left, then return
+int blocking_queue_close(BlockingQueue* self);
+
+// Function to get the current length (number of elements) in the queue
+size_t blocking_queue_length(BlockingQueue* self);
+
+// Function to destroy the queue and the elements left in it, once no thread uses it
+void blocking_queue_destroy(BlockingQueue* self);
+
+#endif /*BLOCKING_QUEUE_H*/
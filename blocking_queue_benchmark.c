@@ -0,0 +1,179 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "blocking_queue.h"
+
+#define CONSUMERS 4
+#define BATCH 64
+
+// Ways for consumers to wait for work
+typedef enum {
+    MODE_POLL = 0,      // Poll queue_length/queue_head under a mutex
+    MODE_SIGNAL_ALL,    // Mutex and condition variable, signalled on every push
+    MODE_POP_WAIT,      // blocking_queue_pop_wait
+    MODE_POP_BATCH,     // blocking_queue_pop_batch
+} Mode;
+
+static const char *mode_names[] = {"poll", "signal every push", "pop_wait", "pop_batch"};
+
+// Structure representing the queue shared by one run, in whichever mode it uses
+typedef struct {
+    Mode mode;
+    BlockingQueue *blocking;
+    Queue *queue;               // Baseline queue for the poll and signal modes
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    BOOL done;
+    uint64_t sum;               // Sum of consumed elements
+} Bench;
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to read the CPU time in milliseconds and the context switches of the process
+static void usage(double *cpu_ms, long *switches) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    *cpu_ms = (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3
+              + (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+    *switches = ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+// Function to pop elements until the queue is finished, the way each mode waits
+static void *consumer_run(void *arg) {
+    Bench *bench = (Bench *)arg;
+    void *batch[BATCH];
+    uint64_t sum = 0;
+
+    for (;;) {
+        size_t n = 0;
+        if (bench->mode == MODE_POP_WAIT) {
+            n = blocking_queue_pop_wait(bench->blocking, batch, -1) == OK;
+        } else if (bench->mode == MODE_POP_BATCH) {
+            n = blocking_queue_pop_batch(bench->blocking, batch, BATCH, -1);
+        } else {
+            BOOL done;
+            pthread_mutex_lock(&bench->lock);
+            while (bench->mode == MODE_SIGNAL_ALL && queue_length(bench->queue) == 0 && !bench->done) {
+                pthread_cond_wait(&bench->not_empty, &bench->lock);
+            }
+            if (queue_head(bench->queue, &batch[0]) == OK) {
+                queue_pop_n(bench->queue, batch, 1);
+                n = 1;
+            }
+            done = bench->done;
+            pthread_mutex_unlock(&bench->lock);
+            if (n == 0 && !done) {
+                sched_yield();
+                continue;
+            }
+        }
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            sum += (uintptr_t)batch[i];
+        }
+    }
+
+    pthread_mutex_lock(&bench->lock);
+    bench->sum += sum;
+    pthread_mutex_unlock(&bench->lock);
+    return NULL;
+}
+
+// Function to push n elements, or none and sleep for idle_ms, then finish the queue
+static void produce(Bench *bench, size_t n, long idle_ms) {
+    for (size_t i = 1; i <= n; i++) {
+        if (bench->mode == MODE_POP_WAIT || bench->mode == MODE_POP_BATCH) {
+            blocking_queue_push(bench->blocking, (void *)i);
+        } else {
+            pthread_mutex_lock(&bench->lock);
+            queue_push(bench->queue, (void *)i);
+            if (bench->mode == MODE_SIGNAL_ALL) {
+                pthread_cond_signal(&bench->not_empty);
+            }
+            pthread_mutex_unlock(&bench->lock);
+        }
+    }
+    if (idle_ms > 0) {
+        struct timespec ts = {idle_ms / 1000, (idle_ms % 1000) * 1000000L};
+        nanosleep(&ts, NULL);
+    }
+
+    if (bench->mode == MODE_POP_WAIT || bench->mode == MODE_POP_BATCH) {
+        blocking_queue_close(bench->blocking);
+    } else {
+        pthread_mutex_lock(&bench->lock);
+        bench->done = TRUE;
+        pthread_cond_broadcast(&bench->not_empty);
+        pthread_mutex_unlock(&bench->lock);
+    }
+}
+
+// Function to run one mode, reporting throughput, CPU time and context switches
+static void bench_run(Mode mode, size_t n, long idle_ms) {
+    Bench bench;
+    pthread_t threads[CONSUMERS];
+    double cpu_start, cpu_end;
+    long switches_start, switches_end;
+
+    bench.mode = mode;
+    bench.blocking = blocking_queue_create(NULL, NULL);
+    bench.queue = queue_create(NULL, NULL);
+    pthread_mutex_init(&bench.lock, NULL);
+    pthread_cond_init(&bench.not_empty, NULL);
+    bench.done = FALSE;
+    bench.sum = 0;
+
+    usage(&cpu_start, &switches_start);
+    double start = now_ns();
+    for (size_t t = 0; t < CONSUMERS; t++) {
+        pthread_create(&threads[t], NULL, consumer_run, &bench);
+    }
+    produce(&bench, n, idle_ms);
+    for (size_t t = 0; t < CONSUMERS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed_ms = (now_ns() - start) / 1e6;
+    usage(&cpu_end, &switches_end);
+
+    if (n == 0) {
+        printf("%-18s %10.1f %12.1f\n", mode_names[mode], elapsed_ms, cpu_end - cpu_start);
+    } else {
+        printf("%-18s %10.2f %12.1f %14.3f %8s\n", mode_names[mode], (double)n / elapsed_ms / 1e3,
+               cpu_end - cpu_start, (double)(switches_end - switches_start) / (double)n * 1e3,
+               bench.sum == (uint64_t)n * (n + 1) / 2 ? "ok" : "MISMATCH");
+    }
+
+    blocking_queue_destroy(bench.blocking);
+    queue_destroy(bench.queue);
+    pthread_cond_destroy(&bench.not_empty);
+    pthread_mutex_destroy(&bench.lock);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+    long idle_ms = argc > 2 ? strtol(argv[2], NULL, 10) : 500;
+
+    printf("%d consumers idle for %ld ms\n", CONSUMERS, idle_ms);
+    printf("%-18s %10s %12s\n", "mode", "wall(ms)", "cpu(ms)");
+    for (int mode = MODE_POLL; mode <= MODE_POP_BATCH; mode++) {
+        bench_run((Mode)mode, 0, idle_ms);
+    }
+
+    printf("\n1 producer, %d consumers, %zu elements\n", CONSUMERS, n);
+    printf("%-18s %10s %12s %14s %8s\n", "mode", "Melem/s", "cpu(ms)", "csw/1k elem", "check");
+    for (int mode = MODE_POLL; mode <= MODE_POP_BATCH; mode++) {
+        bench_run((Mode)mode, n, 0);
+    }
+    return 0;
+}
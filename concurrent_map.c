@@ -0,0 +1,182 @@
+#include <stdint.h>
+#include "concurrent_map.h"
+
+#define CONCURRENT_MAP_DEFAULT_SEGMENTS 64
+
+// Structure to represent context for visiting key-value pairs across segments
+typedef struct {
+    MapKvVisitFunc visit;
+    void* ctx;
+    BOOL stopped;
+} ConcurrentVisitCtx;
+
+// Function to get the segment a key hash belongs to.
+// The hash is multiplied before taking its top bits, so the segment choice does not
+// correlate with the low bits the segment's own table indexes with.
+static inline ConcurrentMapSegment *concurrent_map_segment(ConcurrentMap *self, void *key) {
+    uint64_t h = self->hash(key) * 0x9e3779b97f4a7c15ULL;
+    return &self->segments[self->segment_shift < 64 ? (size_t)(h >> self->segment_shift) : 0];
+}
+
+// Create a new concurrent map with segment_n lock stripes
+ConcurrentMap *concurrent_map_create(MapKvDestroyFunc data_destroy, void *ctx, MapHash64Func key_hash,
+                                     size_t segment_n) {
+    return_val_if_fail(key_hash != NULL, NULL);
+    ConcurrentMap *self = (ConcurrentMap *)STL_MALLOC(sizeof(ConcurrentMap));
+    size_t n = 1;
+    int bits = 0;
+
+    if (self == NULL) {
+        return NULL;
+    }
+    if (segment_n == 0) {
+        segment_n = CONCURRENT_MAP_DEFAULT_SEGMENTS;
+    }
+    // Clamping keeps the rounding below finite, the segment block's size from overflowing and bits under 64
+    if (segment_n > CONCURRENT_MAP_MAX_SEGMENTS) {
+        segment_n = CONCURRENT_MAP_MAX_SEGMENTS;
+    }
+    while (n < segment_n) {
+        n <<= 1;
+        bits++;
+    }
+    self->hash = key_hash;
+    self->segment_n = n;
+    self->segment_shift = 64 - bits;
+
+    // Over-allocate by one cache line and align the segments inside the block
+    self->segments_mem = STL_MALLOC(sizeof(ConcurrentMapSegment) * n + CONCURRENT_MAP_CACHE_LINE);
+    if (self->segments_mem == NULL) {
+        STL_FREE(self);
+        return NULL;
+    }
+    uintptr_t addr = ((uintptr_t)self->segments_mem + CONCURRENT_MAP_CACHE_LINE - 1)
+                     & ~(uintptr_t)(CONCURRENT_MAP_CACHE_LINE - 1);
+    self->segments = (ConcurrentMapSegment *)addr;
+
+    for (size_t i = 0; i < n; i++) {
+        ConcurrentMapSegment *segment = &self->segments[i];
+        // Each segment resizes on its own, so a growing segment only blocks the keys it holds
+        segment->map = map_create_hash64(data_destroy, ctx, key_hash, MAP_ENGINE_OPEN);
+        if (segment->map == NULL || pthread_rwlock_init(&segment->lock, NULL) != 0) {
+            map_destroy(segment->map);
+            self->segment_n = i;
+            concurrent_map_destroy(self);
+            return NULL;
+        }
+    }
+    return self;
+}
+
+// Function to insert a key-value pair or replace the pair stored for the key
+int concurrent_map_set(ConcurrentMap *self, DataCompareFunc cmp, void *key, void *value) {
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+    ConcurrentMapSegment *segment = concurrent_map_segment(self, key);
+
+    pthread_rwlock_wrlock(&segment->lock);
+    int ret = map_upsert(segment->map, cmp, key, value);
+    pthread_rwlock_unlock(&segment->lock);
+    return ret;
+}
+
+// Function to insert a key-value pair only when the key is absent
+int concurrent_map_insert_if_absent(ConcurrentMap *self, DataCompareFunc cmp, void *key, void *value) {
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+    ConcurrentMapSegment *segment = concurrent_map_segment(self, key);
+
+    pthread_rwlock_wrlock(&segment->lock);
+    int ret = map_insert_if_absent(segment->map, cmp, key, value);
+    pthread_rwlock_unlock(&segment->lock);
+    return ret;
+}
+
+// Function to update the value of a key in place with the segment locked, inserting the key when absent
+int concurrent_map_update(ConcurrentMap *self, DataCompareFunc cmp, void *key, ConcurrentMapUpdateFunc update,
+                          void *ctx) {
+    return_val_if_fail(self != NULL && cmp != NULL && update != NULL, ERR_NIL);
+    ConcurrentMapSegment *segment = concurrent_map_segment(self, key);
+    void **value = NULL;
+    BOOL inserted = FALSE;
+
+    pthread_rwlock_wrlock(&segment->lock);
+    int ret = map_get_or_insert(segment->map, cmp, key, &value, &inserted);
+    if (ret == OK) {
+        update(ctx, key, value, inserted);
+    }
+    pthread_rwlock_unlock(&segment->lock);
+    return ret;
+}
+
+// Function to delete a key-value pair from the map
+int concurrent_map_delete(ConcurrentMap *self, DataCompareFunc cmp, void *key) {
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+    ConcurrentMapSegment *segment = concurrent_map_segment(self, key);
+
+    pthread_rwlock_wrlock(&segment->lock);
+    int ret = map_delete(segment->map, cmp, key);
+    pthread_rwlock_unlock(&segment->lock);
+    return ret;
+}
+
+// Function to get the value associated with a key in the map.
+// Lookups in the open addressing engine never modify the table, so readers share the lock.
+int concurrent_map_get(ConcurrentMap *self, DataCompareFunc cmp, void *key, void **value) {
+    return_val_if_fail(self != NULL && cmp != NULL && value != NULL, ERR_NIL);
+    ConcurrentMapSegment *segment = concurrent_map_segment(self, key);
+
+    pthread_rwlock_rdlock(&segment->lock);
+    int ret = map_get(segment->map, cmp, key, value);
+    pthread_rwlock_unlock(&segment->lock);
+    return ret;
+}
+
+// Function to get the number of key-value pairs in the map
+size_t concurrent_map_length(ConcurrentMap *self) {
+    return_val_if_fail(self != NULL, 0);
+    size_t size = 0;
+
+    for (size_t i = 0; i < self->segment_n; i++) {
+        pthread_rwlock_rdlock(&self->segments[i].lock);
+        size += map_length(self->segments[i].map);
+        pthread_rwlock_unlock(&self->segments[i].lock);
+    }
+    return size;
+}
+
+// Function to visit a key-value pair of one segment, remembering when the visit asks to stop
+static int concurrent_map_visit(void *ctx, void *key, void *value) {
+    ConcurrentVisitCtx *visit_ctx = (ConcurrentVisitCtx *)ctx;
+    if (!visit_ctx->visit(visit_ctx->ctx, key, value)) {
+        visit_ctx->stopped = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Function to iterate over key-value pairs one segment at a time
+int concurrent_map_foreach(ConcurrentMap *self, MapKvVisitFunc visit, void *ctx) {
+    return_val_if_fail(self != NULL && visit != NULL, ERR_NIL);
+    ConcurrentVisitCtx visit_ctx;
+    visit_ctx.visit = visit;
+    visit_ctx.ctx = ctx;
+    visit_ctx.stopped = FALSE;
+
+    for (size_t i = 0; i < self->segment_n && !visit_ctx.stopped; i++) {
+        pthread_rwlock_rdlock(&self->segments[i].lock);
+        map_foreach(self->segments[i].map, concurrent_map_visit, &visit_ctx);
+        pthread_rwlock_unlock(&self->segments[i].lock);
+    }
+    return OK;
+}
+
+// Function to destroy the map
+void concurrent_map_destroy(ConcurrentMap *self) {
+    if (self != NULL) {
+        for (size_t i = 0; i < self->segment_n; i++) {
+            pthread_rwlock_destroy(&self->segments[i].lock);
+            map_destroy(self->segments[i].map);
+        }
+        STL_FREE(self->segments_mem);
+        STL_FREE(self);
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CONCURRENT_MAP_H
+#define CONCURRENT_MAP_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "typedef.h"
+#include "map.h"
+
+// Function pointer type for updating the value of a key in place, called with the segment locked.
+// inserted tells whether the key was absent and has just been stored with a NULL value.
+typedef void (*ConcurrentMapUpdateFunc)(void* ctx, void* key, void** value, BOOL inserted);
+
+#define CONCURRENT_MAP_CACHE_LINE 64
+
+// Largest number of segments a map is created with; more stripes than this only cost memory
+#define CONCURRENT_MAP_MAX_SEGMENTS (1 << 16)
+
+// Structure to represent one lock stripe of a concurrent map.
+// Segments start on their own cache line so threads locking neighbouring segments do not contend.
+typedef struct {
+    _Alignas(CONCURRENT_MAP_CACHE_LINE) pthread_rwlock_t lock; // Shared by readers, exclusive for writers and resizes
+    Map* map;   // Open addressing map holding the keys whose hash selects this segment
+} ConcurrentMapSegment;
+
+// Structure to represent a concurrent map, a fixed set of independently locked segments
+typedef struct {
+    MapHash64Func         hash;           // 64-bit hash function for keys
+    ConcurrentMapSegment* segments;       // Segments, aligned to a cache line inside segments_mem
+    void*                 segments_mem;   // Allocation holding the segments
+    size_t                segment_n;      // Number of segments, a power of two
+    int                   segment_shift;  // Shift selecting a segment from the top bits of a hash
+} ConcurrentMap;
+
+// Create a new concurrent map with segment_n lock stripes (rounded up to a power of two, 0 picks 64,
+// and at most CONCURRENT_MAP_MAX_SEGMENTS)
+ConcurrentMap* concurrent_map_create(MapKvDestroyFunc data_destroy, void* ctx, MapHash64Func key_hash,
+                                     size_t segment_n);
+
+// Insert a key-value pair, or replace the pair already stored for the key (see map_upsert)
+int concurrent_map_set(ConcurrentMap* self, DataCompareFunc cmp, void* key, void* value);
+
+// Insert a key-value pair only when the key is absent, returns ERR_EXIST otherwise
+int concurrent_map_insert_if_absent(ConcurrentMap* self, DataCompareFunc cmp, void* key, void* value);
+
+// Update the value of a key atomically with respect to other threads, inserting the key when absent
+int concurrent_map_update(ConcurrentMap* self, DataCompareFunc cmp, void* key, ConcurrentMapUpdateFunc update,
+                          void* ctx);
+
+// Delete a key-value pair from the map
+int concurrent_map_delete(ConcurrentMap* self, DataCompareFunc cmp, void* key);
+
+// Get the value associated with a key. Readers of one segment run in parallel.
+// The returned value is not protected once the call returns: callers that delete or
+// replace values from other threads must coordinate its lifetime themselves.
+int concurrent_map_get(ConcurrentMap* self, DataCompareFunc cmp, void* key, void** value);
+
+// Get the number of key-value pairs, a snapshot that may be stale while other threads write
+size_t concurrent_map_length(ConcurrentMap* self);
+
+// Iterate over key-value pairs one segment at a time, holding that segment's read lock.
+// visit must not modify the map.
+int concurrent_map_foreach(ConcurrentMap* self, MapKvVisitFunc visit, void* ctx);
+
+// Destroy the map, which no other thread may still be using
+void concurrent_map_destroy(ConcurrentMap* self);
+
+#endif /*CONCURRENT_MAP_H*/
@@ -0,0 +1,159 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "concurrent_map.h"
+
+// Number of distinct keys the threads operate on, half of them present at the start
+#define KEY_N (1 << 20)
+
+// Comparison function for keys
+static int kv_cmp(void *i, void *j) {
+    return strcmp((char *) i, (char *) j);
+}
+
+// Structure to represent a map shared by all threads behind one mutex, the baseline
+typedef struct {
+    pthread_mutex_t lock;
+    Map *map;
+} LockedMap;
+
+// Structure to represent the work of one benchmark thread
+typedef struct {
+    ConcurrentMap *concurrent;  // Map under test, NULL to use locked instead
+    LockedMap *locked;
+    char **keys;
+    size_t ops;
+    unsigned write_percent;
+    uint64_t seed;
+} Worker;
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to draw the next number of a per-thread xorshift generator
+static inline uint64_t next_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// Function to run a mix of lookups, upserts and deletes on random keys
+static void *worker_run(void *arg) {
+    Worker *worker = (Worker *)arg;
+    void *value = NULL;
+
+    for (size_t i = 0; i < worker->ops; i++) {
+        uint64_t r = next_random(&worker->seed);
+        char *key = worker->keys[(r >> 16) % KEY_N];
+        unsigned dice = (unsigned)(r % 100);
+        BOOL write = dice < worker->write_percent;
+
+        if (worker->concurrent != NULL) {
+            if (!write) {
+                concurrent_map_get(worker->concurrent, kv_cmp, key, &value);
+            } else if (dice % 2 == 0) {
+                concurrent_map_set(worker->concurrent, kv_cmp, key, key);
+            } else {
+                concurrent_map_delete(worker->concurrent, kv_cmp, key);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&worker->locked->lock);
+        if (!write) {
+            map_get(worker->locked->map, kv_cmp, key, &value);
+        } else if (dice % 2 == 0) {
+            map_upsert(worker->locked->map, kv_cmp, key, key);
+        } else {
+            map_delete(worker->locked->map, kv_cmp, key);
+        }
+        pthread_mutex_unlock(&worker->locked->lock);
+    }
+    return NULL;
+}
+
+// Function to measure the throughput of one map kind with thread_n threads, in million operations per second
+static double bench_mix(BOOL concurrent, char **keys, size_t thread_n, size_t ops, unsigned write_percent) {
+    ConcurrentMap *map = NULL;
+    LockedMap locked;
+    pthread_t threads[64];
+    Worker workers[64];
+
+    if (concurrent) {
+        map = concurrent_map_create(NULL, NULL, map_hash_string, 0);
+        for (size_t i = 0; i < KEY_N; i += 2) {
+            concurrent_map_set(map, kv_cmp, keys[i], keys[i]);
+        }
+    } else {
+        pthread_mutex_init(&locked.lock, NULL);
+        locked.map = map_create_hash64(NULL, NULL, map_hash_string, MAP_ENGINE_OPEN);
+        for (size_t i = 0; i < KEY_N; i += 2) {
+            map_upsert(locked.map, kv_cmp, keys[i], keys[i]);
+        }
+    }
+
+    for (size_t t = 0; t < thread_n; t++) {
+        workers[t].concurrent = map;
+        workers[t].locked = &locked;
+        workers[t].keys = keys;
+        workers[t].ops = ops / thread_n;
+        workers[t].write_percent = write_percent;
+        workers[t].seed = 0x9e3779b97f4a7c15ULL * (t + 1);
+    }
+
+    double start = now_ns();
+    for (size_t t = 0; t < thread_n; t++) {
+        pthread_create(&threads[t], NULL, worker_run, &workers[t]);
+    }
+    for (size_t t = 0; t < thread_n; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = now_ns() - start;
+
+    if (concurrent) {
+        concurrent_map_destroy(map);
+    } else {
+        map_destroy(locked.map);
+        pthread_mutex_destroy(&locked.lock);
+    }
+    return (double)(ops / thread_n * thread_n) / elapsed * 1e3;
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_threads = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    size_t ops = argc > 2 ? strtoul(argv[2], NULL, 10) : 4000000;
+    unsigned mixes[2] = {5, 50};
+    char **keys = (char **)malloc(KEY_N * sizeof(char *));
+
+    max_threads = max_threads > 64 ? 64 : max_threads;
+    for (size_t i = 0; i < KEY_N; i++) {
+        keys[i] = (char *)malloc(24);
+        snprintf(keys[i], 24, "key%zu", i);
+    }
+
+    printf("%zu operations over %d keys (Mops/s)\n", ops, KEY_N);
+    printf("%-8s %-8s %12s %12s %9s\n", "writes", "threads", "mutex+map", "concurrent", "speedup");
+    for (int m = 0; m < 2; m++) {
+        for (size_t thread_n = 1; thread_n <= max_threads; thread_n *= 2) {
+            double locked = bench_mix(FALSE, keys, thread_n, ops, mixes[m]);
+            double concurrent = bench_mix(TRUE, keys, thread_n, ops, mixes[m]);
+            printf("%-7u%% %-8zu %12.2f %12.2f %8.2fx\n", mixes[m], thread_n, locked, concurrent,
+                   concurrent / locked);
+        }
+    }
+
+    for (size_t i = 0; i < KEY_N; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,353 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "external_sort.h"
+#include "sort.h"
+
+// Structure representing a sorted run in a spill file, as a range of records
+typedef struct {
+    uint64_t first;     // Index of the run's first record in the file
+    uint64_t count;     // Number of records in the run
+} ExternalSortRun;
+
+// Structure representing a temporary file holding sorted runs back to back
+typedef struct {
+    FILE* file;
+    ExternalSortRun* runs;
+    size_t run_n;
+    size_t run_cap;
+    uint64_t records;   // Records written to the file so far
+} ExternalSortSpill;
+
+// Structure representing the buffered read position in one run being merged
+typedef struct {
+    int fd;
+    uint64_t offset;    // Byte offset in the file of the next record to read into the buffer
+    uint64_t left;      // Records of the run not read into the buffer yet
+    char* buffer;
+    size_t capacity;    // Records the buffer has room for
+    size_t count;       // Records in the buffer
+    size_t pos;         // Index in the buffer of the run's current record
+} ExternalSortReader;
+
+// Structure representing the state of one external_sort call
+typedef struct {
+    size_t record_size;
+    DataCompareFunc cmp;
+    size_t fan_in;
+    const char* temp_dir;
+    char* memory;       // Records of a run and their pointers, then the read buffers of a merge
+    size_t memory_size;
+    char* block;        // Records gathered for the next write
+    size_t block_size;
+    size_t block_used;
+} ExternalSort;
+
+// Function to write the gathered records to file
+static int external_sort_flush(ExternalSort* self, FILE* file) {
+    if (self->block_used > 0 && fwrite(self->block, 1, self->block_used, file) != self->block_used) {
+        return ERR_IO;
+    }
+    self->block_used = 0;
+    return OK;
+}
+
+// Function to append a record to the records gathered for file, writing them out when the block is full
+static inline int external_sort_emit(ExternalSort* self, FILE* file, const char* record) {
+    if (self->block_used + self->record_size > self->block_size && external_sort_flush(self, file) != OK) {
+        return ERR_IO;
+    }
+    memcpy(self->block + self->block_used, record, self->record_size);
+    self->block_used += self->record_size;
+    return OK;
+}
+
+// Function to create a spill file in the temporary directory; it is unlinked at once and goes away when closed
+static int external_sort_spill_open(ExternalSort* self, ExternalSortSpill* spill) {
+    size_t len = strlen(self->temp_dir) + sizeof("/cstl-sort-XXXXXX");
+    char* path = (char*)STL_MALLOC(len);
+    int fd;
+
+    memset(spill, 0, sizeof(ExternalSortSpill));
+    if (path == NULL) {
+        return ERR_OOM;
+    }
+    snprintf(path, len, "%s/cstl-sort-XXXXXX", self->temp_dir);
+    if ((fd = mkstemp(path)) >= 0) {
+        unlink(path);
+        if ((spill->file = fdopen(fd, "w+b")) == NULL) {
+            close(fd);
+        } else {
+            // Writes already go out in whole blocks, a stdio buffer would only add a copy
+            setvbuf(spill->file, NULL, _IONBF, 0);
+        }
+    }
+    STL_FREE(path);
+    return spill->file != NULL ? OK : ERR_IO;
+}
+
+// Function to record that the next count records written to the spill file form a run
+static int external_sort_spill_add(ExternalSortSpill* spill, uint64_t count) {
+    if (spill->run_n == spill->run_cap) {
+        size_t cap = spill->run_cap == 0 ? 16 : spill->run_cap * 2;
+        ExternalSortRun* runs = NULL;
+        // The first list comes from STL_MALLOC so that STL_FREE's leak count matches; realloc only grows it
+        if (spill->runs == NULL) {
+            runs = (ExternalSortRun*)STL_MALLOC(cap * sizeof(ExternalSortRun));
+        } else {
+            runs = (ExternalSortRun*)realloc(spill->runs, cap * sizeof(ExternalSortRun));
+        }
+        if (runs == NULL) {
+            return ERR_OOM;
+        }
+        spill->runs = runs;
+        spill->run_cap = cap;
+    }
+    spill->runs[spill->run_n++] = (ExternalSortRun){spill->records, count};
+    spill->records += count;
+    return OK;
+}
+
+// Function to close a spill file and release its run list
+static void external_sort_spill_close(ExternalSortSpill* spill) {
+    if (spill->file != NULL) {
+        fclose(spill->file);
+    }
+    STL_FREE(spill->runs);
+    memset(spill, 0, sizeof(ExternalSortSpill));
+}
+
+// Function to read the next records of a run into its buffer, leaving count at 0 once the run is exhausted
+static int external_sort_refill(ExternalSort* self, ExternalSortReader* reader) {
+    size_t count = reader->left < reader->capacity ? (size_t)reader->left : reader->capacity;
+    size_t bytes = count * self->record_size;
+    size_t done = 0;
+
+    while (done < bytes) {
+        ssize_t n = pread(reader->fd, reader->buffer + done, bytes - done, (off_t)(reader->offset + done));
+        if (n <= 0) {
+            return ERR_IO;
+        }
+        done += (size_t)n;
+    }
+    reader->offset += bytes;
+    reader->left -= count;
+    reader->count = count;
+    reader->pos = 0;
+    return OK;
+}
+
+// Function to check whether the current record of reader a orders before that of reader b.
+// Exhausted runs order last, and ties go to the earlier run.
+static inline BOOL external_sort_beats(ExternalSort* self, ExternalSortReader* readers, size_t a, size_t b) {
+    ExternalSortReader* ra = &readers[a];
+    ExternalSortReader* rb = &readers[b];
+    if (ra->count == 0 || rb->count == 0) {
+        return rb->count == 0 && (ra->count != 0 || a < b);
+    }
+    int ret = self->cmp(ra->buffer + ra->pos * self->record_size, rb->buffer + rb->pos * self->record_size);
+    return ret < 0 || (ret == 0 && a < b);
+}
+
+// Function to merge runs [first, first + n) of a spill file into out, with a loser tree: tree[0] holds the
+// reader with the smallest current record and every internal node the reader that lost the match played there,
+// so replacing the winner's record replays only the log2(n) matches on its path to the root
+static int external_sort_merge(ExternalSort* self, ExternalSortSpill* spill, size_t first, size_t n, FILE* out) {
+    size_t bytes = self->memory_size - n * (sizeof(ExternalSortReader) + 2 * sizeof(size_t));
+    size_t capacity = bytes / n / self->record_size;
+    ExternalSortReader* readers = (ExternalSortReader*)self->memory;
+    size_t* tree = (size_t*)(readers + n);
+    size_t* winners = tree + n;
+    char* buffer = (char*)(winners + n);
+    int ret = OK;
+
+    if (capacity == 0) {
+        return ERR_OOM;
+    }
+    for (size_t i = 0; i < n; i++) {
+        ExternalSortRun* run = &spill->runs[first + i];
+        readers[i] = (ExternalSortReader){fileno(spill->file), run->first * self->record_size, run->count,
+                                          buffer + i * capacity * self->record_size, capacity, 0, 0};
+        if ((ret = external_sort_refill(self, &readers[i])) != OK) {
+            return ret;
+        }
+    }
+
+    // Leaves are nodes n to 2n - 1 standing for readers 0 to n - 1; play the matches bottom up
+    for (size_t node = n - 1; node > 0; node--) {
+        size_t left = 2 * node >= n ? 2 * node - n : winners[2 * node];
+        size_t right = 2 * node + 1 >= n ? 2 * node + 1 - n : winners[2 * node + 1];
+        BOOL left_wins = external_sort_beats(self, readers, left, right);
+        winners[node] = left_wins ? left : right;
+        tree[node] = left_wins ? right : left;
+    }
+    tree[0] = n > 1 ? winners[1] : 0;
+
+    while (readers[tree[0]].count != 0) {
+        size_t winner = tree[0];
+        ExternalSortReader* reader = &readers[winner];
+        if ((ret = external_sort_emit(self, out, reader->buffer + reader->pos * self->record_size)) != OK) {
+            return ret;
+        }
+        if (++reader->pos == reader->count) {
+            if (reader->left == 0) {
+                reader->count = 0;
+            } else if ((ret = external_sort_refill(self, reader)) != OK) {
+                return ret;
+            }
+        }
+
+        for (size_t node = (winner + n) / 2; node > 0; node /= 2) {
+            if (external_sort_beats(self, readers, tree[node], winner)) {
+                size_t loser = winner;
+                winner = tree[node];
+                tree[node] = loser;
+            }
+        }
+        tree[0] = winner;
+    }
+    return external_sort_flush(self, out);
+}
+
+// Function to read the input in runs that fit in memory, sort each, and spill them unless the whole input
+// fits in one run, in which case it is written straight to output and *done is set
+static int external_sort_runs(ExternalSort* self, const char* input, const char* output,
+                              ExternalSortSpill* spill, BOOL* done) {
+    size_t capacity = self->memory_size / (self->record_size + sizeof(void*));
+    void** ptrs = (void**)self->memory;
+    char* records = self->memory + capacity * sizeof(void*);
+    FILE* in = fopen(input, "rb");
+    FILE* out = NULL;
+    int ret = OK;
+
+    *done = FALSE;
+    if (in == NULL) {
+        return ERR_IO;
+    }
+    while (ret == OK) {
+        size_t bytes = fread(records, 1, capacity * self->record_size, in);
+        size_t count = bytes / self->record_size;
+        if (bytes % self->record_size != 0 || ferror(in)) {
+            ret = ERR_IO;
+            break;
+        }
+        if (count == 0 && spill->file != NULL) {
+            break;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            ptrs[i] = records + i * self->record_size;
+        }
+        quick_sort_ptr(ptrs, count, (SortCmpFunc)self->cmp);
+
+        // Input that fits in one run needs no spill file; it is fully read before output is opened
+        if (spill->file == NULL && count < capacity) {
+            if ((out = fopen(output, "wb")) == NULL) {
+                ret = ERR_IO;
+                break;
+            }
+            for (size_t i = 0; i < count && ret == OK; i++) {
+                ret = external_sort_emit(self, out, (const char*)ptrs[i]);
+            }
+            if (ret == OK) {
+                ret = external_sort_flush(self, out);
+            }
+            if (fclose(out) != 0 && ret == OK) {
+                ret = ERR_IO;
+            }
+            *done = TRUE;
+            break;
+        }
+
+        if (spill->file == NULL && (ret = external_sort_spill_open(self, spill)) != OK) {
+            break;
+        }
+        for (size_t i = 0; i < count && ret == OK; i++) {
+            ret = external_sort_emit(self, spill->file, (const char*)ptrs[i]);
+        }
+        if (ret == OK && (ret = external_sort_flush(self, spill->file)) == OK) {
+            ret = external_sort_spill_add(spill, count);
+        }
+    }
+    fclose(in);
+    return ret;
+}
+
+// Function to sort a file of fixed-size records into output
+int external_sort(const char* input, const char* output, size_t record_size, DataCompareFunc cmp,
+                  const ExternalSortOptions* options) {
+    return_val_if_fail(input != NULL && output != NULL && record_size > 0 && cmp != NULL, ERR_NIL);
+    ExternalSort self;
+    ExternalSortSpill spill;
+    size_t memory = options != NULL && options->memory > 0 ? options->memory : EXTERNAL_SORT_MEMORY;
+    BOOL done = FALSE;
+    int ret;
+
+    memset(&spill, 0, sizeof(ExternalSortSpill));
+    self.record_size = record_size;
+    self.cmp = cmp;
+    self.fan_in = options != NULL && options->fan_in > 0 ? options->fan_in : EXTERNAL_SORT_FAN_IN;
+    self.fan_in = self.fan_in < 2 ? 2 : self.fan_in;
+    self.temp_dir = options != NULL && options->temp_dir != NULL ? options->temp_dir : getenv("TMPDIR");
+    self.temp_dir = self.temp_dir != NULL ? self.temp_dir : "/tmp";
+    self.block_size = EXTERNAL_SORT_BLOCK / record_size * record_size;
+    self.block_size = self.block_size == 0 ? record_size : self.block_size;
+    self.block_used = 0;
+
+    // The block comes out of the budget, the rest must hold two records and their pointers at least
+    self.memory_size = memory > self.block_size ? memory - self.block_size : 0;
+    if (self.memory_size < 2 * (record_size + sizeof(void*))) {
+        self.memory_size = 2 * (record_size + sizeof(void*));
+    }
+    // A merge needs a reader, two tree slots and one record per run
+    size_t per_run = sizeof(ExternalSortReader) + 2 * sizeof(size_t) + record_size;
+    if (self.fan_in > self.memory_size / per_run) {
+        self.fan_in = self.memory_size / per_run < 2 ? 2 : self.memory_size / per_run;
+        self.memory_size = self.memory_size < self.fan_in * per_run ? self.fan_in * per_run : self.memory_size;
+    }
+
+    self.memory = (char*)STL_MALLOC(self.memory_size);
+    self.block = (char*)STL_MALLOC(self.block_size);
+    if (self.memory == NULL || self.block == NULL) {
+        STL_FREE(self.memory);
+        STL_FREE(self.block);
+        return ERR_OOM;
+    }
+
+    ret = external_sort_runs(&self, input, output, &spill, &done);
+
+    // Merge fan_in runs at a time into a new spill file until one merge can produce the output
+    while (ret == OK && !done && spill.run_n > self.fan_in) {
+        ExternalSortSpill next;
+        if ((ret = external_sort_spill_open(&self, &next)) != OK) {
+            break;
+        }
+        for (size_t first = 0; first < spill.run_n && ret == OK; first += self.fan_in) {
+            size_t n = spill.run_n - first < self.fan_in ? spill.run_n - first : self.fan_in;
+            if ((ret = external_sort_merge(&self, &spill, first, n, next.file)) == OK) {
+                uint64_t count = spill.runs[first + n - 1].first + spill.runs[first + n - 1].count - spill.runs[first].first;
+                ret = external_sort_spill_add(&next, count);
+            }
+        }
+        external_sort_spill_close(&spill);
+        spill = next;
+    }
+
+    if (ret == OK && !done) {
+        FILE* out = fopen(output, "wb");
+        if (out == NULL) {
+            ret = ERR_IO;
+        } else {
+            ret = external_sort_merge(&self, &spill, 0, spill.run_n, out);
+            if (fclose(out) != 0 && ret == OK) {
+                ret = ERR_IO;
+            }
+        }
+    }
+
+    external_sort_spill_close(&spill);
+    STL_FREE(self.memory);
+    STL_FREE(self.block);
+    return ret;
+}
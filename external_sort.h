@@ -0,0 +1,33 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <stdio.h>
+#include "typedef.h"
+
+// Memory an external sort uses when the options leave it at 0: the size of the sorted runs, and of
+// the read buffers shared by the runs of a merge
+#define EXTERNAL_SORT_MEMORY ((size_t)256 << 20)
+
+// Number of runs merged at once when the options leave it at 0
+#define EXTERNAL_SORT_FAN_IN 64
+
+// Size of the buffer records are gathered into before they are written, taken out of the memory budget
+#define EXTERNAL_SORT_BLOCK ((size_t)1 << 20)
+
+// Structure representing the settings of an external sort; fields left at 0 or NULL take the defaults
+typedef struct {
+    size_t memory;          // Bytes of memory for records, pointers and buffers, EXTERNAL_SORT_MEMORY by default
+    size_t fan_in;          // Most runs merged at once, EXTERNAL_SORT_FAN_IN by default; at least 2
+    const char* temp_dir;   // Directory of the temporary run files, $TMPDIR or /tmp by default
+} ExternalSortOptions;
+
+// Function to sort a file of fixed-size records into output, which may be the input file itself.
+// Runs that fit in the memory budget are sorted with quick_sort_ptr and spilled to a temporary file, then
+// merged fan_in at a time with a loser tree over buffered reads, in as many passes as it takes.
+// cmp is called like array_sort's, with pointers to two records. The sort is not stable.
+// Returns ERR_IO when a file cannot be read or written or the input is not a whole number of records,
+// and ERR_OOM when the budget cannot be allocated.
+int external_sort(const char* input, const char* output, size_t record_size, DataCompareFunc cmp,
+                  const ExternalSortOptions* options);
+
+#endif /*EXTERNAL_SORT_H*/
@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "external_sort.h"
+
+// Record layout of the classic sort benchmark: a 10-byte key followed by a 90-byte payload
+#define RECORD_SIZE 100
+#define KEY_SIZE 10
+
+// Comparison function ordering records by key bytes
+int record_cmp(void *a, void *b) {
+    return memcmp(a, b, KEY_SIZE);
+}
+
+// Function to get a random 64-bit value
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = (*state += 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Function to get the current monotonic time in milliseconds
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// Function to write n random records to path, returning the sum of their first key bytes as a checksum
+static uint64_t generate(const char *path, size_t n) {
+    FILE *file = fopen(path, "wb");
+    char record[RECORD_SIZE];
+    uint64_t state = 42;
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = next_random(&state);
+        memcpy(record, &r, sizeof(r));
+        r = next_random(&state);
+        memcpy(record + sizeof(r), &r, KEY_SIZE - sizeof(r));
+        memset(record + KEY_SIZE, (int)(i & 0x7f), RECORD_SIZE - KEY_SIZE);
+        sum += (unsigned char)record[0];
+        fwrite(record, RECORD_SIZE, 1, file);
+    }
+    fclose(file);
+    return sum;
+}
+
+// Function to check that path holds n records in key order with the given checksum
+static int verify(const char *path, size_t n, uint64_t sum) {
+    FILE *file = fopen(path, "rb");
+    char prev[RECORD_SIZE];
+    char record[RECORD_SIZE];
+    size_t count = 0;
+    uint64_t check = 0;
+    int ok = file != NULL;
+
+    while (ok && fread(record, RECORD_SIZE, 1, file) == 1) {
+        if (count > 0 && record_cmp(prev, record) > 0) {
+            ok = 0;
+        }
+        check += (unsigned char)record[0];
+        memcpy(prev, record, RECORD_SIZE);
+        count++;
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    return ok && count == n && check == sum;
+}
+
+int main(int argc, char *argv[]) {
+    size_t size_mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+    size_t memory_mb = argc > 2 ? strtoul(argv[2], NULL, 10) : EXTERNAL_SORT_MEMORY >> 20;
+    const char *dir = argc > 3 ? argv[3] : "/tmp";
+    size_t n = (size_mb << 20) / RECORD_SIZE;
+    char input[4096];
+    char output[4096];
+
+    snprintf(input, sizeof(input), "%s/external_sort_benchmark.in", dir);
+    snprintf(output, sizeof(output), "%s/external_sort_benchmark.out", dir);
+
+    double start = now_ms();
+    uint64_t sum = generate(input, n);
+    double generate_ms = now_ms() - start;
+    printf("%zu records of %d bytes (%zu MB) generated in %.1f s, %zu MB memory budget\n", n, RECORD_SIZE, size_mb,
+           generate_ms / 1e3, memory_mb);
+    printf("%-8s %10s %10s %10s %8s\n", "fan-in", "runs", "sort(s)", "MB/s", "check");
+
+    // The default fan-in merges every run in one pass; a fan-in of 4 adds intermediate passes over the data
+    size_t fan_ins[] = {EXTERNAL_SORT_FAN_IN, 4};
+    for (size_t i = 0; i < sizeof(fan_ins) / sizeof(fan_ins[0]); i++) {
+        ExternalSortOptions options = {memory_mb << 20, fan_ins[i], dir};
+        size_t runs = (n + (options.memory - EXTERNAL_SORT_BLOCK) / (RECORD_SIZE + sizeof(void*)) - 1)
+                      / ((options.memory - EXTERNAL_SORT_BLOCK) / (RECORD_SIZE + sizeof(void*)));
+
+        start = now_ms();
+        int ret = external_sort(input, output, RECORD_SIZE, record_cmp, &options);
+        double sort_ms = now_ms() - start;
+        int ok = ret == OK && verify(output, n, sum);
+        printf("%-8zu %10zu %10.1f %10.1f %8s\n", fan_ins[i], runs, sort_ms / 1e3, size_mb / (sort_ms / 1e3),
+               ok ? "ok" : "MISMATCH");
+    }
+
+    remove(input);
+    remove(output);
+    return 0;
+}
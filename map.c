@@ -1,3 +1,4 @@
+#include <stdint.h>
 #include "list.h"
 #include "map.h"
 
@@ -5,40 +6,71 @@
 typedef struct {
     void* key;
     void* value;
+    uint64_t hash;  // Cached hash of the key
 } MapKv;
 
 // Structure to represent context for key comparison
 typedef struct {
     DataCompareFunc cmp;
     void* key;
+    uint64_t hash;
 } CmpCtx;
 
 // Structure to represent context for key-value visiting
 typedef struct {
     MapKvVisitFunc visit;
     void* ctx;
+    BOOL stopped;       // Set once visit returns FALSE, ending the walk over the remaining slots
 } VisitCtx;
 
 #define MIN_SLOT_SIZE 16
 
-// Create a new map
-Map *map_create(MapKvDestroyFunc data_destroy, void *ctx, MapHashFunc key_hash) {
-    Map *self = NULL;
-    return_val_if_fail(key_hash != NULL, NULL);
-    self = (Map *)STL_MALLOC(sizeof(Map));
+// Number of keys map_get_many and map_set_many hash and prefetch before resolving them
+#define MAP_BATCH_SIZE 16
+
+// Function to allocate the slot array of the open addressing engine
+static int map_open_init(Map *self, size_t slot_n) {
+    self->entries = (MapEntry *)STL_MALLOC(sizeof(MapEntry) * slot_n);
+    if (self->entries == NULL) {
+        return ERR_OOM;
+    }
+    self->slot_n = slot_n;
+    // Robin Hood probing keeps probe sequences short up to a 7/8 load
+    self->threshold = slot_n - slot_n / 8;
+    return OK;
+}
+
+// Function to allocate a map with either a 32-bit or a 64-bit hash function
+static Map *map_alloc(MapKvDestroyFunc data_destroy, void *ctx, MapHashFunc key_hash, MapHash64Func key_hash64,
+                      MapEngine engine) {
+    Map *self = (Map *)STL_MALLOC(sizeof(Map));
 
     if (self != NULL) {
         // Initialize map attributes
         self->hash = key_hash;
+        self->hash64 = key_hash64;
+        self->engine = engine;
         self->slot_n = MIN_SLOT_SIZE;
+        self->size = 0;
         self->data_destroy_ctx = ctx;
         self->data_destroy = data_destroy;
         self->prototype = NULL;
         self->load_factor = 0;
         self->threshold = (size_t)((double)self->slot_n * 0.75);
-
-        // Allocate memory for slots
-        if ((self->slots = (List **)STL_MALLOC(sizeof(List *) * self->slot_n)) == NULL) {
+        self->slots = NULL;
+        self->entries = NULL;
+        self->rehash_slots = NULL;
+        self->rehash_slot_n = 0;
+        self->rehash_index = 0;
+        self->rehash_step = 0;
+
+        if (engine == MAP_ENGINE_OPEN) {
+            if (map_open_init(self, MIN_SLOT_SIZE) != OK) {
+                STL_FREE(self);
+                self = NULL;
+            }
+        } else if ((self->slots = (List **)STL_MALLOC(sizeof(List *) * self->slot_n)) == NULL) {
+            // Allocate memory for slots
             STL_FREE(self);
             self = NULL;
         }
@@ -46,12 +78,66 @@ Map *map_create(MapKvDestroyFunc data_destroy, void *ctx, MapHashFunc key_hash)
     return self;
 }
 
+// Create a new map backed by the given storage engine
+Map *map_create_with_engine(MapKvDestroyFunc data_destroy, void *ctx, MapHashFunc key_hash, MapEngine engine) {
+    return_val_if_fail(key_hash != NULL, NULL);
+    return map_alloc(data_destroy, ctx, key_hash, NULL, engine);
+}
+
+// Create a new map hashing keys with a 64-bit hash function
+Map *map_create_hash64(MapKvDestroyFunc data_destroy, void *ctx, MapHash64Func key_hash, MapEngine engine) {
+    return_val_if_fail(key_hash != NULL, NULL);
+    return map_alloc(data_destroy, ctx, NULL, key_hash, engine);
+}
+
+// Create a new map
+Map *map_create(MapKvDestroyFunc data_destroy, void *ctx, MapHashFunc key_hash) {
+    return map_create_with_engine(data_destroy, ctx, key_hash, MAP_ENGINE_CHAINED);
+}
+
+// Function to hash a byte buffer (FNV-1a, 64-bit)
+uint64_t map_hash_bytes(const void *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Function to hash a NUL-terminated string key (FNV-1a, 64-bit)
+uint64_t map_hash_string(void *key) {
+    const unsigned char *p = (const unsigned char *)key;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*p != '\0') {
+        h ^= *p++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Function to compute the hash of a key with whichever hash function the map was created with
+static inline uint64_t map_key_hash(Map *self, void *key) {
+    if (self->hash64 != NULL) {
+        return self->hash64(key);
+    }
+    return (uint64_t)(unsigned int)self->hash(key);
+}
+
+// Function to release a key-value pair through the user destroy function
+static void map_destroy_pair(Map *self, void *key, void *value) {
+    if (self->data_destroy != NULL) {
+        self->data_destroy(self->data_destroy_ctx, key, value);
+    }
+}
+
 // Function to destroy key-value pairs
 void map_kv_destroy(void* ctx, void* data) {
     MapKv *kv = (MapKv*)data;
     Map* self = (Map*) ctx;
     // Destroy key-value pair
-    self->data_destroy(self->data_destroy_ctx, kv->key, kv->value);
+    map_destroy_pair(self, kv->key, kv->value);
     STL_FREE(kv);
 }
 
@@ -62,7 +148,11 @@ int map_kv_visit(void* ctx, size_t i, void* data) {
 
     // Invoke the visit function on the key-value pair
     if (visitCtx->visit != NULL) {
-        return visitCtx->visit(visitCtx->ctx, kv->key, kv->value);
+        if (!visitCtx->visit(visitCtx->ctx, kv->key, kv->value)) {
+            visitCtx->stopped = TRUE;
+            return FALSE;
+        }
+        return TRUE;
     }
     return OK;
 }
@@ -71,212 +161,761 @@ int map_kv_visit(void* ctx, size_t i, void* data) {
 int map_kv_cmp(void* ctx, void* data) {
     CmpCtx* cmp_ctx = (CmpCtx*)ctx;
     MapKv *kv = (MapKv*)data;
+    // Entries with a different cached hash cannot match, skip the comparator
+    if (kv->hash != cmp_ctx->hash) {
+        return 1;
+    }
     // Invoke the key comparison function
     return cmp_ctx->cmp(cmp_ctx->key, kv->key);
 }
 
-// Function to visit key-value pairs during map expansion
+// Function to visit key-value pairs while they migrate into the table being rehashed into
 int map_expand_visit(void* ctx, size_t i, void* data) {
-    Map* expanded = (Map*)ctx;
+    Map* self = (Map*)ctx;
     MapKv *kv = (MapKv*)data;
 
-    // Calculate the index in the expanded map
-    size_t index = expanded->hash(kv->key) % expanded->slot_n;
+    // Calculate the index in the expanded table from the cached hash
+    size_t index = kv->hash % self->rehash_slot_n;
 
     // Create a new list if the slot is empty
-    if (expanded->slots[index] == NULL) {
-        expanded->slots[index] = list_create(map_kv_destroy, expanded->prototype);
+    if (self->rehash_slots[index] == NULL) {
+        self->rehash_slots[index] = list_create(map_kv_destroy, self);
     } else {
-        expanded->load_factor++;
+        self->load_factor++;
     }
 
-    // Prepend the key-value pair to the list
-    return list_prepend(expanded->slots[index], kv);
+    // Prepend the key-value pair to the list, a FALSE return would stop list_foreach
+    return list_prepend(self->rehash_slots[index], kv) == OK;
 }
 
-// Function to destroy key-value pairs during map expansion
-void map_expand_destroy(Map *self) {
-    if (self != NULL) {
-        for (size_t i = 0; i < self->slot_n; i++) {
-            if (self->slots[i] != NULL) {
-                // Disable data destruction during list destruction
-                self->slots[i]->data_destroy = NULL;
-                // Destroy the list
-                list_destroy(self->slots[i]);
-                self->slots[i] = NULL;
-            }
-        }
-        // Free the array of slots
-        STL_FREE(self->slots);
+// Function to start a rehash into a table twice the current size
+static int map_rehash_start(Map *self) {
+    size_t slot_n = self->slot_n * 2;
+    List **slots = (List **)STL_MALLOC(sizeof(List *) * slot_n);
+
+    // Allocate memory for slots in the expanded table
+    if (slots == NULL) {
+        return ERR_OOM;
     }
+    self->rehash_slots = slots;
+    self->rehash_slot_n = slot_n;
+    self->rehash_index = 0;
+    // From now on the load factor tracks the expanded table
+    self->load_factor = 0;
+    self->threshold = (size_t)((double)slot_n * 0.75);
+    return OK;
 }
 
-// Function to initialize the expanded map during map expansion
-int map_expand_init(Map *self, Map *newly) {
-    newly->prototype = self;
-    newly->hash = self->hash;
-    newly->slot_n = self->slot_n * 2;
-    newly->data_destroy_ctx = self->data_destroy_ctx;
-    newly->data_destroy = self->data_destroy;
-    newly->load_factor = 0;
-    newly->threshold = (size_t)((double)newly->slot_n * 0.75);
+// Function to migrate one slot of the old table into the expanded table
+static void map_rehash_slot(Map *self, size_t index) {
+    List *list = self->slots[index];
+    if (list != NULL) {
+        list_foreach(list, map_expand_visit, self);
+        // Disable data destruction during list destruction
+        list->data_destroy = NULL;
+        list_destroy(list);
+        self->slots[index] = NULL;
+    }
+}
 
-    // Allocate memory for slots in the expanded map
-    if ((newly->slots = (List **)STL_MALLOC(sizeof(List *) * newly->slot_n)) == NULL) {
-        return ERR_OOM;
+// Function to migrate up to n slots of a pending rehash
+BOOL map_rehash(Map *self, size_t n) {
+    return_val_if_fail(self != NULL, FALSE);
+    if (self->rehash_slots == NULL) {
+        return FALSE;
     }
+
+    // Empty slots are cheap but still bounded, so one call never walks a huge empty table
+    size_t empty_visits = n > SIZE_MAX / 10 ? SIZE_MAX : n * 10;
+    while (n > 0 && self->rehash_index < self->slot_n) {
+        if (self->slots[self->rehash_index] != NULL) {
+            map_rehash_slot(self, self->rehash_index);
+            n--;
+        } else if (--empty_visits == 0) {
+            self->rehash_index++;
+            break;
+        }
+        self->rehash_index++;
+    }
+
+    if (self->rehash_index >= self->slot_n) {
+        // Every slot has migrated, so the expanded table becomes the only one
+        STL_FREE(self->slots);
+        self->slots = self->rehash_slots;
+        self->slot_n = self->rehash_slot_n;
+        self->rehash_slots = NULL;
+        self->rehash_slot_n = 0;
+        self->rehash_index = 0;
+    }
+    return self->rehash_slots != NULL;
+}
+
+// Function to set how many slots each operation migrates during a rehash
+int map_set_rehash_step(Map *self, size_t step) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    self->rehash_step = step;
     return OK;
 }
 
 // Function to expand the map
 int map_expand(Map *self) {
-    Map newly;
     int ret;
-    // Initialize the expanded map
-    if (ret = map_expand_init(self, &newly) != OK) {
+    // A rehash still in progress is completed before the table grows again
+    map_rehash(self, SIZE_MAX);
+
+    if ((ret = map_rehash_start(self)) != OK) {
         return ret;
     }
-
-    // Iterate over existing key-value pairs and visit them during map expansion
-    for (size_t i = 0; i < self->slot_n; i++) {
-        List *list = self->slots[i];
-        if (list != NULL) {
-            list_foreach(self->slots[i], map_expand_visit, &newly);
-        }
+    if (self->rehash_step == 0) {
+        map_rehash(self, SIZE_MAX);
     }
-
-    // Destroy the existing map
-    map_expand_destroy(self);
-    // Update the map with the expanded map's attributes
-    self->slots = newly.slots;
-    self->slot_n = newly.slot_n;
-    self->load_factor = newly.load_factor;
-    self->threshold = newly.threshold;
     return OK;
 }
 
-// Function to set a key-value pair in the map
-int map_set(Map *self, void* key, void *value) {
-    return_val_if_fail(self != NULL, -1);
-
-    // Calculate the index for the key in the map
-    size_t index = self->hash(key) % self->slot_n;
-    MapKv* kv = (MapKv *)STL_MALLOC(sizeof(MapKv));
-    kv->key = key;
-    kv->value = value;
+// Function to get the slot that new entries with a hash go to, creating its list when needed
+static List **map_chained_insert_slot(Map *self, uint64_t hash) {
+    List **slot = self->rehash_slots != NULL
+                  ? &self->rehash_slots[hash % self->rehash_slot_n]
+                  : &self->slots[hash % self->slot_n];
 
     // Create a new list if the slot is empty
-    if (self->slots[index] == NULL) {
-        self->slots[index] = list_create(map_kv_destroy, self);
+    if (*slot == NULL) {
+        *slot = list_create(map_kv_destroy, self);
     } else {
         self->load_factor++;
     }
+    return slot;
+}
+
+// Function to find a key in a chained map, returning its list and position in the list.
+// During a rehash the expanded table holds the newest entries, so it is searched first.
+static MapKv *map_chained_find(Map *self, DataCompareFunc cmp, void *key, uint64_t hash, List **list, int *index) {
+    List *lists[2] = {NULL, self->slots[hash % self->slot_n]};
+    CmpCtx ctx;
+    ctx.key = key;
+    ctx.cmp = cmp;
+    ctx.hash = hash;
+
+    if (self->rehash_slots != NULL) {
+        lists[0] = self->rehash_slots[hash % self->rehash_slot_n];
+    }
+
+    for (int i = 0; i < 2; i++) {
+        MapKv *kv = NULL;
+        if (lists[i] != NULL) {
+            // Find the key-value pair in the list
+            int found = list_find_data(lists[i], map_kv_cmp, &ctx, (void**)&kv);
+            if (found >= 0) {
+                *list = lists[i];
+                *index = found;
+                return kv;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Function to insert a key-value pair with a known hash into a chained map
+static int map_chained_insert(Map *self, void* key, void *value, uint64_t hash, MapKv **inserted) {
+    int ret;
+    MapKv* kv = (MapKv *)STL_MALLOC(sizeof(MapKv));
+    return_val_if_fail(kv != NULL, ERR_OOM);
+    kv->key = key;
+    kv->value = value;
+    kv->hash = hash;
+
+    // Calculate the slot for the key in the map
+    List **slot = map_chained_insert_slot(self, hash);
 
     // Check if map expansion is needed
     if (self->load_factor >= self->threshold) {
-        int ret;
         // Expand the map
-        if (ret = map_expand(self) != OK) {
+        if ((ret = map_expand(self)) != OK) {
+            STL_FREE(kv);
             return ret;
-        };
+        }
+        // The tables changed, so locate the slot again
+        slot = map_chained_insert_slot(self, hash);
     }
+
     // Prepend the key-value pair to the list
-    return list_prepend(self->slots[index], kv);
+    if ((ret = list_prepend(*slot, kv)) != OK) {
+        STL_FREE(kv);
+        return ret;
+    }
+    self->size++;
+    if (inserted != NULL) {
+        *inserted = kv;
+    }
+    return OK;
 }
 
-// Function to delete a key-value pair from the map
-int map_delete(Map *self, DataCompareFunc cmp, void *key) {
-    size_t index = 0;
-    List *list = NULL;
-    return_val_if_fail(self != NULL && cmp != NULL, -1);
+// Function to set a key-value pair in a chained map
+static int map_chained_set(Map *self, void* key, void *value) {
+    return map_chained_insert(self, key, value, map_key_hash(self, key), NULL);
+}
 
-    // Calculate the index for the key in the map
-    index = self->hash(key) % self->slot_n;
-    list = self->slots[index];
+// Function to delete a key-value pair from a chained map
+static int map_chained_delete(Map *self, DataCompareFunc cmp, void *key) {
+    List *list = NULL;
+    int index = 0;
+    MapKv *kv = map_chained_find(self, cmp, key, map_key_hash(self, key), &list, &index);
 
-    if (list != NULL){
-        CmpCtx ctx;
-        ctx.key = key;
-        ctx.cmp = cmp;
-        index = list_find(list, map_kv_cmp, &ctx);
-        return list_delete(list, index);
+    if (kv != NULL && list_delete(list, index) == OK) {
+        self->size--;
+        return OK;
     }
     return ERR_NIL;
 }
 
-// Function to get the number of key-value pairs in the map
-size_t map_length(Map *self) {
+// Function to get the value associated with a key in a chained map
+static int map_chained_get(Map *self, DataCompareFunc cmp, void *key, void **value) {
+    List *list = NULL;
+    int index = 0;
+    MapKv *kv = map_chained_find(self, cmp, key, map_key_hash(self, key), &list, &index);
+
+    if (kv == NULL) {
+        return ERR_NIL;
+    }
+    *value = kv->value;
+    return OK;
+}
+
+// Function to iterate over key-value pairs in a chained map
+static int map_chained_foreach(Map *self, MapKvVisitFunc visit, void *ctx) {
     size_t i = 0;
-    size_t nr = 0;
-    return_val_if_fail(self != NULL, 0);
 
-    // Iterate over all slots and count the number of key-value pairs
-    for (i = 0; i < self->slot_n; i++) {
+    // Context for visiting key-value pairs
+    VisitCtx visitCtx;
+    visitCtx.ctx = ctx;
+    visitCtx.visit = visit;
+    visitCtx.stopped = FALSE;
+
+    // Iterate over all slots and visit key-value pairs in each list, until a visit returns FALSE
+    for (i = 0; i < self->slot_n && !visitCtx.stopped; i++){
         if (self->slots[i] != NULL) {
-            nr += list_length(self->slots[i]);
+            list_foreach(self->slots[i], map_kv_visit, &visitCtx);
         }
     }
-    return nr;
+    // Entries that already migrated during a rehash live in the expanded table
+    for (i = 0; self->rehash_slots != NULL && i < self->rehash_slot_n && !visitCtx.stopped; i++) {
+        if (self->rehash_slots[i] != NULL) {
+            list_foreach(self->rehash_slots[i], map_kv_visit, &visitCtx);
+        }
+    }
+    return OK;
 }
 
-// Function to get the value associated with a key in the map
-int map_get(Map *self, DataCompareFunc cmp, void *key, void **value) {
-    int index = 0;
-    List *list = NULL;
-    return_val_if_fail(self != NULL && cmp != NULL && value != NULL, -1);
+// Function to destroy the slots of a chained map
+static void map_chained_destroy(Map *self) {
+    for (size_t i = 0; i < self->slot_n; i++) {
+        if (self->slots[i] != NULL) {
+            // Destroy each list in the slot
+            list_destroy(self->slots[i]);
+            self->slots[i] = NULL;
+        }
+    }
+    // Free the array of slots
+    STL_FREE(self->slots);
 
-    // Calculate the index for the key in the map
-    index = self->hash(key) % self->slot_n;
-    list = self->slots[index];
+    for (size_t i = 0; self->rehash_slots != NULL && i < self->rehash_slot_n; i++) {
+        list_destroy(self->rehash_slots[i]);
+    }
+    STL_FREE(self->rehash_slots);
+}
 
-    if (list != NULL) {
-        CmpCtx ctx;
-        ctx.key = key;
-        ctx.cmp = cmp;
-        MapKv *kv = NULL;
+// Function to compute the hash used by the open addressing engine.
+// The user hash is mixed so that weak hashes still spread over the power-of-two table.
+static inline uint64_t map_open_hash(Map *self, void *key) {
+    uint64_t h = map_key_hash(self, key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h != 0 ? h : 1;
+}
+
+// Function to get how far the entry at pos is from its home slot
+static inline size_t map_open_dist(Map *self, size_t pos) {
+    return (pos - (size_t)self->entries[pos].hash) & (self->slot_n - 1);
+}
 
-        // Find the key-value pair in the list
-        index = list_find_data(list, map_kv_cmp, &ctx, (void**)&kv);
-        if (index < 0) {
-            return ERR_NIL;
+// Function to place an entry into a slot array, returning the index it was stored at.
+// Entries sharing a home slot are kept newest-first like the chained engine's lists:
+// a newest entry goes in front of its peers, displaced entries shift right in order.
+static size_t map_open_place(MapEntry *entries, size_t slot_n, MapEntry entry, BOOL newest) {
+    size_t mask = slot_n - 1;
+    size_t pos = (size_t)entry.hash & mask;
+    size_t placed = slot_n;
+
+    for (size_t dist = 0;; dist++, pos = (pos + 1) & mask) {
+        MapEntry *slot = &entries[pos];
+        if (slot->hash == 0) {
+            *slot = entry;
+            return placed < slot_n ? placed : pos;
         }
-        *value = kv->value;
+
+        size_t slot_dist = (pos - (size_t)slot->hash) & mask;
+        if (slot_dist < dist || (slot_dist == dist && newest)) {
+            MapEntry tmp = *slot;
+            *slot = entry;
+            entry = tmp;
+            dist = slot_dist;
+            newest = TRUE;
+            if (placed == slot_n) {
+                placed = pos;
+            }
+        }
+    }
+}
+
+// Function to double the slot array of an open addressing map
+static int map_open_expand(Map *self) {
+    Map newly;
+    size_t mask = self->slot_n - 1;
+    size_t start = 0;
+
+    if (map_open_init(&newly, self->slot_n * 2) != OK) {
+        return ERR_OOM;
+    }
+
+    // Walk from an empty slot so no probe sequence wraps around the walk,
+    // which keeps the order of entries sharing a hash
+    while (self->entries[start].hash != 0) {
+        start++;
+    }
+    for (size_t n = 0; n < self->slot_n; n++) {
+        MapEntry *entry = &self->entries[(start + n) & mask];
+        if (entry->hash != 0) {
+            map_open_place(newly.entries, newly.slot_n, *entry, FALSE);
+        }
+    }
+
+    STL_FREE(self->entries);
+    self->entries = newly.entries;
+    self->slot_n = newly.slot_n;
+    self->threshold = newly.threshold;
+    return OK;
+}
+
+// Function to find the entry holding a key in an open addressing map
+static MapEntry *map_open_find(Map *self, DataCompareFunc cmp, void *key, uint64_t hash) {
+    size_t mask = self->slot_n - 1;
+    size_t pos = (size_t)hash & mask;
+
+    for (size_t dist = 0;; dist++, pos = (pos + 1) & mask) {
+        MapEntry *entry = &self->entries[pos];
+        // Stop at an empty slot or at an entry closer to its home than the key would be
+        if (entry->hash == 0 || map_open_dist(self, pos) < dist) {
+            return NULL;
+        }
+        if (entry->hash == hash && cmp(key, entry->key) == 0) {
+            return entry;
+        }
+    }
+}
+
+// Function to remove an entry from an open addressing map without destroying it
+static void map_open_remove(Map *self, MapEntry *entry) {
+    size_t mask = self->slot_n - 1;
+    size_t pos = (size_t)(entry - self->entries);
+    size_t next = (pos + 1) & mask;
+
+    // Shift the following entries back instead of leaving a tombstone
+    while (self->entries[next].hash != 0 && map_open_dist(self, next) != 0) {
+        self->entries[pos] = self->entries[next];
+        pos = next;
+        next = (next + 1) & mask;
+    }
+    self->entries[pos].hash = 0;
+    self->entries[pos].key = NULL;
+    self->entries[pos].value = NULL;
+    self->size--;
+}
+
+// Function to find a key in an open addressing map, or the slot it would be inserted at.
+// Returns the slot index and sets *found; one probe sequence serves both outcomes.
+static size_t map_open_probe(Map *self, DataCompareFunc cmp, void *key, uint64_t hash, BOOL *found) {
+    size_t mask = self->slot_n - 1;
+    size_t pos = (size_t)hash & mask;
+
+    for (size_t dist = 0;; dist++, pos = (pos + 1) & mask) {
+        MapEntry *entry = &self->entries[pos];
+        if (entry->hash == 0 || map_open_dist(self, pos) < dist) {
+            *found = FALSE;
+            return pos;
+        }
+        if (entry->hash == hash && cmp(key, entry->key) == 0) {
+            *found = TRUE;
+            return pos;
+        }
+    }
+}
+
+// Function to insert an entry at a slot returned by map_open_probe, shifting the rest of the run right
+static void map_open_insert_at(Map *self, size_t pos, MapEntry entry) {
+    size_t mask = self->slot_n - 1;
+    while (self->entries[pos].hash != 0) {
+        MapEntry tmp = self->entries[pos];
+        self->entries[pos] = entry;
+        entry = tmp;
+        pos = (pos + 1) & mask;
+    }
+    self->entries[pos] = entry;
+    self->size++;
+}
+
+// Function to set a key-value pair with a known hash in an open addressing map
+static int map_open_insert(Map *self, void *key, void *value, uint64_t hash) {
+    MapEntry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.hash = hash;
+
+    if (self->size + 1 > self->threshold && map_open_expand(self) != OK) {
+        return ERR_OOM;
+    }
+    map_open_place(self->entries, self->slot_n, entry, TRUE);
+    self->size++;
+    return OK;
+}
+
+// Function to set a key-value pair in an open addressing map
+static int map_open_set(Map *self, void *key, void *value) {
+    return map_open_insert(self, key, value, map_open_hash(self, key));
+}
+
+// Function to delete a key-value pair from an open addressing map
+static int map_open_delete(Map *self, DataCompareFunc cmp, void *key) {
+    MapEntry *entry = map_open_find(self, cmp, key, map_open_hash(self, key));
+    if (entry == NULL) {
+        return ERR_NIL;
+    }
+
+    void *old_key = entry->key;
+    void *old_value = entry->value;
+    map_open_remove(self, entry);
+    map_destroy_pair(self, old_key, old_value);
+    return OK;
+}
+
+// Function to get the value associated with a key in an open addressing map
+static int map_open_get(Map *self, DataCompareFunc cmp, void *key, void **value) {
+    MapEntry *entry = map_open_find(self, cmp, key, map_open_hash(self, key));
+    if (entry == NULL) {
+        return ERR_NIL;
+    }
+    *value = entry->value;
+    return OK;
+}
+
+// Function to iterate over key-value pairs in an open addressing map
+static int map_open_foreach(Map *self, MapKvVisitFunc visit, void *ctx) {
+    for (size_t i = 0; i < self->slot_n; i++) {
+        MapEntry *entry = &self->entries[i];
+        if (entry->hash != 0 && !visit(ctx, entry->key, entry->value)) {
+            break;
+        }
+    }
+    return OK;
+}
+
+// Function to destroy the slot array of an open addressing map
+static void map_open_destroy(Map *self) {
+    for (size_t i = 0; i < self->slot_n; i++) {
+        MapEntry *entry = &self->entries[i];
+        if (entry->hash != 0) {
+            map_destroy_pair(self, entry->key, entry->value);
+        }
+    }
+    STL_FREE(self->entries);
+}
+
+// Function to migrate the configured number of slots for n operations when a progressive rehash is pending
+static inline void map_rehash_step(Map *self, size_t n) {
+    if (self->rehash_slots != NULL && self->rehash_step > 0) {
+        map_rehash(self, self->rehash_step * n);
+    }
+}
+
+// Function to replace a stored pair, releasing the previous key and value unless they are stored again.
+// A half that is stored again is passed to the destroy function as NULL.
+static void map_replace_pair(Map *self, void **stored_key, void **stored_value, void *key, void *value) {
+    void *old_key = *stored_key != key ? *stored_key : NULL;
+    void *old_value = *stored_value != value ? *stored_value : NULL;
+
+    *stored_key = key;
+    *stored_value = value;
+    if (old_key != NULL || old_value != NULL) {
+        map_destroy_pair(self, old_key, old_value);
+    }
+}
+
+// Function to find a key or insert it, with one hash computation and one probe sequence.
+// On return *key_slot and *value_slot point into the stored entry.
+static int map_find_or_insert(Map *self, DataCompareFunc cmp, void *key, void *value,
+                              void ***key_slot, void ***value_slot, BOOL *inserted) {
+    map_rehash_step(self, 1);
+
+    if (self->engine == MAP_ENGINE_OPEN) {
+        BOOL found = FALSE;
+        uint64_t hash = map_open_hash(self, key);
+        size_t pos = map_open_probe(self, cmp, key, hash, &found);
+        // A missing key may need the table grown; growing moves every entry, so the insert slot is probed again
+        if (!found && self->size + 1 > self->threshold) {
+            if (map_open_expand(self) != OK) {
+                return ERR_OOM;
+            }
+            pos = map_open_probe(self, cmp, key, hash, &found);
+        }
+        if (!found) {
+            MapEntry entry;
+            entry.key = key;
+            entry.value = value;
+            entry.hash = hash;
+            map_open_insert_at(self, pos, entry);
+        }
+        *key_slot = &self->entries[pos].key;
+        *value_slot = &self->entries[pos].value;
+        *inserted = !found;
         return OK;
     }
-    return ERR_NIL;
+
+    List *list = NULL;
+    int index = 0;
+    uint64_t hash = map_key_hash(self, key);
+    MapKv *kv = map_chained_find(self, cmp, key, hash, &list, &index);
+
+    *inserted = kv == NULL;
+    if (kv == NULL) {
+        int ret = map_chained_insert(self, key, value, hash, &kv);
+        if (ret != OK) {
+            return ret;
+        }
+    }
+    *key_slot = &kv->key;
+    *value_slot = &kv->value;
+    return OK;
 }
 
-// Function to iterate over key-value pairs in the map
-int map_foreach(Map *self, MapKvVisitFunc visit, void *ctx) {
-    size_t i = 0;
-    return_val_if_fail(self != NULL && visit != NULL, -1);
+// Function to insert a key-value pair or replace the pair stored for the key
+int map_upsert(Map *self, DataCompareFunc cmp, void *key, void *value) {
+    void **key_slot = NULL;
+    void **value_slot = NULL;
+    BOOL inserted = FALSE;
+    int ret;
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
 
-    // Context for visiting key-value pairs
-    VisitCtx visitCtx;
-    visitCtx.ctx = ctx;
-    visitCtx.visit = visit;
+    if ((ret = map_find_or_insert(self, cmp, key, value, &key_slot, &value_slot, &inserted)) != OK) {
+        return ret;
+    }
+    if (!inserted) {
+        map_replace_pair(self, key_slot, value_slot, key, value);
+    }
+    return OK;
+}
 
-    // Iterate over all slots and visit key-value pairs in each list
-    for (i = 0; i < self->slot_n; i++){
-        if (self->slots[i] != NULL) {
-            list_foreach(self->slots[i], map_kv_visit, &visitCtx);
+// Function to get the value slot for a key, inserting the key with a NULL value when absent
+int map_get_or_insert(Map *self, DataCompareFunc cmp, void *key, void ***value, BOOL *inserted) {
+    void **key_slot = NULL;
+    BOOL is_new = FALSE;
+    int ret;
+    return_val_if_fail(self != NULL && cmp != NULL && value != NULL, ERR_NIL);
+
+    if ((ret = map_find_or_insert(self, cmp, key, NULL, &key_slot, value, &is_new)) != OK) {
+        return ret;
+    }
+    if (inserted != NULL) {
+        *inserted = is_new;
+    }
+    return OK;
+}
+
+// Function to insert a key-value pair only when the key is absent
+int map_insert_if_absent(Map *self, DataCompareFunc cmp, void *key, void *value) {
+    void **key_slot = NULL;
+    void **value_slot = NULL;
+    BOOL inserted = FALSE;
+    int ret;
+    return_val_if_fail(self != NULL && cmp != NULL, ERR_NIL);
+
+    if ((ret = map_find_or_insert(self, cmp, key, value, &key_slot, &value_slot, &inserted)) != OK) {
+        return ret;
+    }
+    return inserted ? OK : ERR_EXIST;
+}
+
+// Function to hash a batch of keys and prefetch the memory resolving them will touch.
+// Each pass loads what the previous pass prefetched, so the cache misses of the whole batch
+// overlap instead of stalling key by key. During a progressive rehash only the expanded
+// table, which is searched first, is prefetched.
+static void map_prefetch_batch(Map *self, void **keys, size_t n, uint64_t *hashes) {
+    size_t index[MAP_BATCH_SIZE];
+    size_t i;
+
+    if (self->engine == MAP_ENGINE_OPEN) {
+        size_t mask = self->slot_n - 1;
+        for (i = 0; i < n; i++) {
+            hashes[i] = map_open_hash(self, keys[i]);
+            STL_PREFETCH(&self->entries[hashes[i] & mask]);
+        }
+        // Prefetch the stored key the comparator will read when the home slot matches
+        for (i = 0; i < n; i++) {
+            MapEntry *entry = &self->entries[hashes[i] & mask];
+            if (entry->hash == hashes[i]) {
+                STL_PREFETCH(entry->key);
+            }
+        }
+        return;
+    }
+
+    List **slots = self->rehash_slots != NULL ? self->rehash_slots : self->slots;
+    size_t slot_n = self->rehash_slots != NULL ? self->rehash_slot_n : self->slot_n;
+    for (i = 0; i < n; i++) {
+        hashes[i] = map_key_hash(self, keys[i]);
+        index[i] = hashes[i] % slot_n;
+        STL_PREFETCH(&slots[index[i]]);
+    }
+    for (i = 0; i < n; i++) {
+        if (slots[index[i]] != NULL) {
+            STL_PREFETCH(slots[index[i]]);
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if (slots[index[i]] != NULL && slots[index[i]]->first != NULL) {
+            STL_PREFETCH(slots[index[i]]->first);
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if (slots[index[i]] != NULL && slots[index[i]]->first != NULL) {
+            STL_PREFETCH(slots[index[i]]->first->data);
+        }
+    }
+    // Prefetch the key of the first pair in the chain when its cached hash matches
+    for (i = 0; i < n; i++) {
+        if (slots[index[i]] != NULL && slots[index[i]]->first != NULL) {
+            MapKv *kv = (MapKv *)slots[index[i]]->first->data;
+            if (kv->hash == hashes[i]) {
+                STL_PREFETCH(kv->key);
+            }
+        }
+    }
+}
+
+// Function to get the values of many keys, hashing and prefetching them in batches
+int map_get_many(Map *self, DataCompareFunc cmp, void **keys, size_t n, void **values, BOOL *found) {
+    uint64_t hashes[MAP_BATCH_SIZE];
+    return_val_if_fail(self != NULL && cmp != NULL && ((keys != NULL && values != NULL) || n == 0), ERR_NIL);
+
+    for (size_t base = 0; base < n; base += MAP_BATCH_SIZE) {
+        size_t batch = n - base < MAP_BATCH_SIZE ? n - base : MAP_BATCH_SIZE;
+        // Migrate rehash slots before prefetching, so the prefetched tables stay current
+        map_rehash_step(self, batch);
+        map_prefetch_batch(self, keys + base, batch, hashes);
+
+        for (size_t i = 0; i < batch; i++) {
+            void *key = keys[base + i];
+            void *value = NULL;
+            BOOL hit;
+            if (self->engine == MAP_ENGINE_OPEN) {
+                MapEntry *entry = map_open_find(self, cmp, key, hashes[i]);
+                hit = entry != NULL;
+                value = hit ? entry->value : NULL;
+            } else {
+                List *list = NULL;
+                int index = 0;
+                MapKv *kv = map_chained_find(self, cmp, key, hashes[i], &list, &index);
+                hit = kv != NULL;
+                value = hit ? kv->value : NULL;
+            }
+            values[base + i] = value;
+            if (found != NULL) {
+                found[base + i] = hit;
+            }
+        }
+    }
+    return OK;
+}
+
+// Function to set many key-value pairs, hashing and prefetching them in batches
+int map_set_many(Map *self, void **keys, void **values, size_t n) {
+    uint64_t hashes[MAP_BATCH_SIZE];
+    int ret;
+    return_val_if_fail(self != NULL && ((keys != NULL && values != NULL) || n == 0), ERR_NIL);
+
+    for (size_t base = 0; base < n; base += MAP_BATCH_SIZE) {
+        size_t batch = n - base < MAP_BATCH_SIZE ? n - base : MAP_BATCH_SIZE;
+        map_rehash_step(self, batch);
+        map_prefetch_batch(self, keys + base, batch, hashes);
+
+        for (size_t i = 0; i < batch; i++) {
+            if (self->engine == MAP_ENGINE_OPEN) {
+                ret = map_open_insert(self, keys[base + i], values[base + i], hashes[i]);
+            } else {
+                ret = map_chained_insert(self, keys[base + i], values[base + i], hashes[i], NULL);
+            }
+            if (ret != OK) {
+                return ret;
+            }
         }
     }
     return OK;
 }
 
+// Function to set a key-value pair in the map
+int map_set(Map *self, void* key, void *value) {
+    return_val_if_fail(self != NULL, -1);
+    map_rehash_step(self, 1);
+    if (self->engine == MAP_ENGINE_OPEN) {
+        return map_open_set(self, key, value);
+    }
+    return map_chained_set(self, key, value);
+}
+
+// Function to delete a key-value pair from the map
+int map_delete(Map *self, DataCompareFunc cmp, void *key) {
+    return_val_if_fail(self != NULL && cmp != NULL, -1);
+    map_rehash_step(self, 1);
+    if (self->engine == MAP_ENGINE_OPEN) {
+        return map_open_delete(self, cmp, key);
+    }
+    return map_chained_delete(self, cmp, key);
+}
+
+// Function to get the number of key-value pairs in the map
+size_t map_length(Map *self) {
+    return_val_if_fail(self != NULL, 0);
+    return self->size;
+}
+
+// Function to get the value associated with a key in the map
+int map_get(Map *self, DataCompareFunc cmp, void *key, void **value) {
+    return_val_if_fail(self != NULL && cmp != NULL && value != NULL, -1);
+    map_rehash_step(self, 1);
+    if (self->engine == MAP_ENGINE_OPEN) {
+        return map_open_get(self, cmp, key, value);
+    }
+    return map_chained_get(self, cmp, key, value);
+}
+
+// Function to iterate over key-value pairs in the map
+int map_foreach(Map *self, MapKvVisitFunc visit, void *ctx) {
+    return_val_if_fail(self != NULL && visit != NULL, -1);
+    if (self->engine == MAP_ENGINE_OPEN) {
+        return map_open_foreach(self, visit, ctx);
+    }
+    return map_chained_foreach(self, visit, ctx);
+}
+
 // Function to destroy the map
 void map_destroy(Map *self) {
     if (self != NULL) {
-        for (size_t i = 0; i < self->slot_n; i++) {
-            if (self->slots[i] != NULL) {
-                // Destroy each list in the slot
-                list_destroy(self->slots[i]);
-                self->slots[i] = NULL;
-            }
+        if (self->engine == MAP_ENGINE_OPEN) {
+            map_open_destroy(self);
+        } else {
+            map_chained_destroy(self);
         }
-        // Free the array of slots
-        STL_FREE(self->slots);
         // Free the map structure
         STL_FREE(self);
     }
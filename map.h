@@ -2,46 +2,119 @@
 #define MAP_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include "typedef.h"
 #include "list.h"
 
 // Function pointer type for hashing keys in the map
 typedef int (*MapHashFunc)(void* key);
 
-// Function pointer type for destroying key-value pairs in the map
+// Function pointer type for hashing keys in the map to full 64-bit values
+typedef uint64_t (*MapHash64Func)(void* key);
+
+// Function pointer type for destroying key-value pairs in the map.
+// When map_upsert replaces a pair and stores the same key (or value) pointer again, only the other half is
+// released, and the half kept is passed as NULL, so either argument may be NULL.
 typedef void (*MapKvDestroyFunc)(void* ctx, void* key, void* value);
 
 // Function pointer type for visiting key-value pairs in the map
 typedef int (*MapKvVisitFunc)(void* ctx, void* key, void* value);
 
+// Storage engines available for a map
+typedef enum {
+    MAP_ENGINE_CHAINED = 0,  // Array of linked lists, one list per slot
+    MAP_ENGINE_OPEN,         // Open addressing with Robin Hood probing over one inline slot array
+} MapEngine;
+
+// Structure to represent an entry stored inline by the open addressing engine
+typedef struct {
+    void*    key;
+    void*    value;
+    uint64_t hash;      // Mixed hash of the key, 0 marks an empty slot
+} MapEntry;
+
 // Structure to represent a map
 typedef struct {
     MapHashFunc    hash;                // Hash function for keys
+    MapHash64Func  hash64;              // 64-bit hash function for keys, used instead of hash when set
+    MapEngine      engine;              // Storage engine of the map
     List**         slots;               // Array of linked lists (slots) to store key-value pairs
+    MapEntry*      entries;             // Slot array of the open addressing engine
     size_t          slot_n;             // Number of slots in the map
+    size_t          size;               // Number of key-value pairs in the map
     MapKvDestroyFunc data_destroy;      // Function to destroy key-value pairs
     void*           data_destroy_ctx;   // Context for data destruction
     void* prototype;    // Prototype object for map initialization
     size_t load_factor;  // Current load factor of the map
     size_t threshold;    // Threshold for resizing the map
+    List**          rehash_slots;       // Slots being filled by a progressive rehash, NULL when idle
+    size_t          rehash_slot_n;      // Number of slots in rehash_slots
+    size_t          rehash_index;       // Next slot of slots to migrate
+    size_t          rehash_step;        // Slots migrated per operation, 0 rehashes all at once
 } Map;
 
 // Create a new map
 Map* map_create(MapKvDestroyFunc data_destroy, void* ctx, MapHashFunc key_hash);
 
+// Create a new map backed by the given storage engine
+Map* map_create_with_engine(MapKvDestroyFunc data_destroy, void* ctx, MapHashFunc key_hash, MapEngine engine);
+
+// Create a new map hashing keys with a 64-bit hash function.
+// Every entry caches its hash, so resizes never call the hash again and
+// lookups only call the comparator for entries whose hash matches.
+Map* map_create_hash64(MapKvDestroyFunc data_destroy, void* ctx, MapHash64Func key_hash, MapEngine engine);
+
+// 64-bit hash of a NUL-terminated string key, usable as a MapHash64Func
+uint64_t map_hash_string(void* key);
+
+// 64-bit hash of a byte buffer
+uint64_t map_hash_bytes(const void* data, size_t len);
+
 // Get the number of key-value pairs in the map
 size_t map_length(Map* self);
 
 // Set a key-value pair in the map
 int map_set(Map* self, void* key, void* value);
 
+// Insert a key-value pair, or replace the pair already stored for the key.
+// A replaced key and value are passed to the destroy function unless they are the ones being stored,
+// in which case NULL is passed in their place.
+int map_upsert(Map* self, DataCompareFunc cmp, void* key, void* value);
+
+// Get a pointer to the value stored for a key for in-place update, inserting the key
+// with a NULL value when it is absent (*inserted tells which happened, may be NULL).
+// The pointer is valid until the map is next modified. The map keeps key only when it was inserted.
+int map_get_or_insert(Map* self, DataCompareFunc cmp, void* key, void*** value, BOOL* inserted);
+
+// Insert a key-value pair only when the key is absent, returns ERR_EXIST and
+// leaves ownership of key and value with the caller otherwise
+int map_insert_if_absent(Map* self, DataCompareFunc cmp, void* key, void* value);
+
 // Delete a key-value pair from the map
 int map_delete(Map* self, DataCompareFunc cmp, void* key);
 
 // Get the value associated with a key in the map
 int map_get(Map* self, DataCompareFunc cmp, void* key, void** value);
 
-// Iterate over key-value pairs in the map
+// Get the values of n keys at once. values[i] receives the value of keys[i], or NULL when the
+// key is absent, and found[i] (found may be NULL) whether it was present. Keys are hashed and
+// their slots prefetched in small batches, so the cache misses of different keys overlap.
+int map_get_many(Map* self, DataCompareFunc cmp, void** keys, size_t n, void** values, BOOL* found);
+
+// Set n key-value pairs at once, like calling map_set for each pair in order but
+// prefetching slots in batches. Stops at the first error; earlier pairs stay stored.
+int map_set_many(Map* self, void** keys, void** values, size_t n);
+
+// Set how many slots each map_set/map_get/map_delete migrates while the map grows.
+// 0 (the default) rehashes the whole table at once; a positive step spreads the
+// rehash over later operations, Redis style. Applies to the chained engine.
+int map_set_rehash_step(Map* self, size_t step);
+
+// Migrate up to n slots of a pending progressive rehash, returns TRUE while one is still in progress
+BOOL map_rehash(Map* self, size_t n);
+
+// Iterate over key-value pairs in the map, in no particular order. A visit returning FALSE stops the whole
+// walk, as in array_foreach and list_foreach, on either engine.
 int map_foreach(Map* self, MapKvVisitFunc visit, void* ctx);
 
 // Destroy the map
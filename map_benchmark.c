@@ -0,0 +1,260 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "map.h"
+
+// Built together with map.c and list.c under STL_MEM_LEAK_CHECK,
+// so malloc_n counts the blocks the map allocates internally.
+int malloc_n = 0;
+
+static const char *engine_names[] = {"chained", "open"};
+
+// Number of comparator calls, to show how often cached hashes avoid them
+static size_t cmp_calls = 0;
+
+// Comparison function for keys
+int kv_cmp(void *i, void *j) {
+    cmp_calls++;
+    return strcmp((char *) i, (char *) j);
+}
+
+// Number of hash function calls
+static size_t hash_calls = 0;
+
+// Hash function for string keys (FNV-1a)
+int hash(void* key) {
+    unsigned int h = 2166136261u;
+    hash_calls++;
+    for (const char *p = (const char*)key; *p != '\0'; p++) {
+        h ^= (unsigned char)*p;
+        h *= 16777619u;
+    }
+    return (int)h;
+}
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to create n distinct string keys, owned by the benchmark rather than the map
+static char **make_keys(size_t n, const char *prefix) {
+    char **keys = (char**)malloc(n * sizeof(char*));
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = (char*)malloc(24);
+        snprintf(keys[i], 24, "%s%zu", prefix, i);
+    }
+    return keys;
+}
+
+// Function to shuffle the key order so lookups do not follow insertion order
+static void shuffle(char **keys, size_t n) {
+    for (size_t i = n; i > 1; i--) {
+        size_t j = (size_t)rand() % i;
+        char *tmp = keys[i - 1];
+        keys[i - 1] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+// Function to measure inserts and lookups for one engine, with the 32-bit or 64-bit hash API
+static void bench_engine(MapEngine engine, BOOL hash64, char **keys, char **misses, size_t n) {
+    Map *map = hash64 ? map_create_hash64(NULL, NULL, map_hash_string, engine)
+                      : map_create_with_engine(NULL, NULL, hash, engine);
+    int allocs = malloc_n;
+
+    double start = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        map_set(map, keys[i], keys[i]);
+    }
+    double insert_ns = (now_ns() - start) / (double)n;
+    double allocs_per_insert = (double)(malloc_n - allocs) / (double)n;
+
+    shuffle(keys, n);
+    size_t found = 0;
+    start = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        void *value = NULL;
+        found += map_get(map, kv_cmp, keys[i], &value) == OK;
+    }
+    double hit_ns = (now_ns() - start) / (double)n;
+
+    size_t calls = cmp_calls;
+    start = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        void *value = NULL;
+        found += map_get(map, kv_cmp, misses[i], &value) == OK;
+    }
+    double miss_ns = (now_ns() - start) / (double)n;
+    double cmp_per_miss = (double)(cmp_calls - calls) / (double)n;
+
+    printf("%-8s %-6s %14.2f %12.1f %12.1f %12.1f %10.3f %8s\n", engine_names[engine], hash64 ? "64" : "32",
+           allocs_per_insert, insert_ns, hit_ns, miss_ns, cmp_per_miss,
+           found == n && map_length(map) == n ? "ok" : "MISMATCH");
+    map_destroy(map);
+}
+
+// Function to count events per key, either with map_get + map_delete + map_set or with map_get_or_insert
+static void bench_counters(MapEngine engine, char **keys, size_t distinct, size_t events, BOOL single_probe) {
+    Map *map = map_create_with_engine(NULL, NULL, hash, engine);
+    size_t calls = hash_calls;
+    srand(7);
+
+    double start = now_ns();
+    for (size_t i = 0; i < events; i++) {
+        char *key = keys[(size_t)rand() % distinct];
+        if (single_probe) {
+            void **count = NULL;
+            map_get_or_insert(map, kv_cmp, key, &count, NULL);
+            *count = (void*)((uintptr_t)*count + 1);
+        } else {
+            void *count = NULL;
+            if (map_get(map, kv_cmp, key, &count) == OK) {
+                map_delete(map, kv_cmp, key);
+            }
+            map_set(map, key, (void*)((uintptr_t)count + 1));
+        }
+    }
+    double ns = (now_ns() - start) / (double)events;
+
+    printf("%-8s %-20s %12.1f %12.2f %8zu\n", engine_names[engine], single_probe ? "map_get_or_insert" : "get+delete+set",
+           ns, (double)(hash_calls - calls) / (double)events, map_length(map));
+    map_destroy(map);
+}
+
+// Function to compare looped map_set/map_get against map_set_many/map_get_many on a table of n keys
+static void bench_batch(MapEngine engine, char **keys, size_t n, size_t lookups, size_t request) {
+    void **values = (void**)malloc(request * sizeof(void*));
+    char **queries = (char**)malloc(lookups * sizeof(char*));
+    double set_ns[2];
+    double get_ns[2];
+    size_t hits[2] = {0, 0};
+    Map *map = NULL;
+
+    for (size_t i = 0; i < lookups; i++) {
+        queries[i] = keys[(size_t)rand() % n];
+    }
+
+    for (int batched = 0; batched < 2; batched++) {
+        map_destroy(map);
+        map = map_create_with_engine(NULL, NULL, hash, engine);
+        double start = now_ns();
+        for (size_t i = 0; i < n; i += request) {
+            size_t count = n - i < request ? n - i : request;
+            if (batched) {
+                map_set_many(map, (void**)keys + i, (void**)keys + i, count);
+            } else {
+                for (size_t j = 0; j < count; j++) {
+                    map_set(map, keys[i + j], keys[i + j]);
+                }
+            }
+        }
+        set_ns[batched] = (now_ns() - start) / (double)n;
+    }
+
+    for (int batched = 0; batched < 2; batched++) {
+        double start = now_ns();
+        for (size_t i = 0; i < lookups; i += request) {
+            size_t count = lookups - i < request ? lookups - i : request;
+            if (batched) {
+                map_get_many(map, kv_cmp, (void**)queries + i, count, values, NULL);
+            } else {
+                for (size_t j = 0; j < count; j++) {
+                    values[j] = NULL;
+                    map_get(map, kv_cmp, queries[i + j], &values[j]);
+                }
+            }
+            for (size_t j = 0; j < count; j++) {
+                hits[batched] += values[j] == queries[i + j];
+            }
+        }
+        get_ns[batched] = (now_ns() - start) / (double)lookups;
+    }
+
+    printf("%-8s %10.1f %10.1f %10.1f %10.1f %8.2fx %8s\n", engine_names[engine], set_ns[0], set_ns[1],
+           get_ns[0], get_ns[1], get_ns[0] / get_ns[1],
+           hits[0] == lookups && hits[1] == lookups && map_length(map) == n ? "ok" : "MISMATCH");
+    map_destroy(map);
+    free(queries);
+    free(values);
+}
+
+// Comparison function for sorting latencies
+static int latency_cmp(const void *i, const void *j) {
+    double a = *(const double*)i;
+    double b = *(const double*)j;
+    return (a > b) - (a < b);
+}
+
+// Function to measure the map_set latency distribution of a chained map for a rehash step
+static void bench_rehash_latency(char **keys, size_t n, size_t step) {
+    Map *map = map_create(NULL, NULL, hash);
+    double *latencies = (double*)malloc(n * sizeof(double));
+    map_set_rehash_step(map, step);
+
+    for (size_t i = 0; i < n; i++) {
+        double start = now_ns();
+        map_set(map, keys[i], keys[i]);
+        latencies[i] = now_ns() - start;
+    }
+    qsort(latencies, n, sizeof(double), latency_cmp);
+
+    printf("%-8zu %12.2f %12.2f %12.2f %12.2f\n", step, latencies[n / 2] / 1e3, latencies[n * 99 / 100] / 1e3,
+           latencies[n * 999 / 1000] / 1e3, latencies[n - 1] / 1e3);
+    free(latencies);
+    map_destroy(map);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t batch_n = argc > 2 ? strtoul(argv[2], NULL, 10) : 16000000;
+    srand(42);
+
+    char **keys = make_keys(n, "key");
+    char **misses = make_keys(n, "miss");
+
+    printf("%zu string keys\n", n);
+    printf("%-8s %-6s %14s %12s %12s %12s %10s %8s\n", "engine", "hash", "allocs/insert", "insert(ns)",
+           "hit(ns)", "miss(ns)", "cmp/miss", "check");
+    bench_engine(MAP_ENGINE_CHAINED, FALSE, keys, misses, n);
+    bench_engine(MAP_ENGINE_CHAINED, TRUE, keys, misses, n);
+    bench_engine(MAP_ENGINE_OPEN, FALSE, keys, misses, n);
+    bench_engine(MAP_ENGINE_OPEN, TRUE, keys, misses, n);
+
+    printf("\ncounting %zu events over %zu keys\n", n, n / 10);
+    printf("%-8s %-20s %12s %12s %8s\n", "engine", "method", "ns/event", "hash/event", "keys");
+    for (int engine = MAP_ENGINE_CHAINED; engine <= MAP_ENGINE_OPEN; engine++) {
+        bench_counters((MapEngine)engine, keys, n / 10, n, FALSE);
+        bench_counters((MapEngine)engine, keys, n / 10, n, TRUE);
+    }
+
+    printf("\nchained map_set latency (us) by rehash step, 0 = rehash at once\n");
+    printf("%-8s %12s %12s %12s %12s\n", "step", "p50", "p99", "p99.9", "max");
+    bench_rehash_latency(keys, n, 0);
+    bench_rehash_latency(keys, n, 1);
+    bench_rehash_latency(keys, n, 16);
+
+    for (size_t i = 0; i < n; i++) {
+        free(keys[i]);
+        free(misses[i]);
+    }
+    free(keys);
+    free(misses);
+
+    // The table and its keys take several hundred MB here, well beyond the last level cache,
+    // so nearly every lookup misses in cache
+    keys = make_keys(batch_n, "batch");
+    printf("\n%zu keys, %zu random lookups in requests of 256 keys (ns per key)\n", batch_n, n);
+    printf("%-8s %10s %10s %10s %10s %9s %8s\n", "engine", "set", "set_many", "get", "get_many", "speedup", "check");
+    bench_batch(MAP_ENGINE_CHAINED, keys, batch_n, n, 256);
+    bench_batch(MAP_ENGINE_OPEN, keys, batch_n, n, 256);
+    for (size_t i = 0; i < batch_n; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include <sched.h>
+#include <stdint.h>
+#include "mpmc_queue.h"
+
+// Number of failed attempts the blocking calls retry busily, then yielding the CPU, before going to sleep
+#define MPMC_QUEUE_SPINS 64
+#define MPMC_QUEUE_YIELDS 16
+
+// Function to create a queue holding up to capacity elements
+MpmcQueue* mpmc_queue_create(size_t capacity, DataDestroyFunc data_destroy, void* ctx) {
+    // Neither rounding capacity up to a power of two nor sizing the cells may overflow
+    return_val_if_fail(capacity <= SIZE_MAX / 2 + 1, NULL);
+    size_t slots = 2;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    return_val_if_fail(slots <= SIZE_MAX / sizeof(MpmcQueueCell), NULL);
+
+    // Over-allocate by one cache line and align the queue inside the block
+    void* mem = STL_MALLOC(sizeof(MpmcQueue) + MPMC_QUEUE_CACHE_LINE);
+    if (mem == NULL) {
+        return NULL;
+    }
+    MpmcQueue* self = (MpmcQueue*)(((uintptr_t)mem + MPMC_QUEUE_CACHE_LINE - 1)
+                                   & ~(uintptr_t)(MPMC_QUEUE_CACHE_LINE - 1));
+    if ((self->cells = (MpmcQueueCell*)STL_MALLOC(slots * sizeof(MpmcQueueCell))) == NULL) {
+        STL_FREE(mem);
+        return NULL;
+    }
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&self->cells[i].seq, i);
+    }
+    atomic_init(&self->tail, 0);
+    atomic_init(&self->head, 0);
+    atomic_init(&self->push_waiters, 0);
+    atomic_init(&self->pop_waiters, 0);
+    self->capacity = slots;
+    self->data_destroy = data_destroy;
+    self->data_destroy_ctx = ctx;
+    self->mem = mem;
+
+    // Unwind whatever was initialized when a later primitive fails
+    int ret = pthread_mutex_init(&self->lock, NULL);
+    if (ret == 0 && (ret = pthread_cond_init(&self->not_full, NULL)) != 0) {
+        pthread_mutex_destroy(&self->lock);
+    }
+    if (ret == 0 && (ret = pthread_cond_init(&self->not_empty, NULL)) != 0) {
+        pthread_cond_destroy(&self->not_full);
+        pthread_mutex_destroy(&self->lock);
+    }
+    if (ret != 0) {
+        STL_FREE(self->cells);
+        STL_FREE(mem);
+        return NULL;
+    }
+    return self;
+}
+
+// Function to claim the tail cell and store an element in it, without waking anyone
+static int mpmc_queue_enqueue(MpmcQueue* self, void* data) {
+    size_t pos = atomic_load_explicit(&self->tail, memory_order_relaxed);
+    MpmcQueueCell* cell;
+
+    for (;;) {
+        cell = &self->cells[pos & (self->capacity - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            // The cell is free on this lap, race other producers for the position
+            if (atomic_compare_exchange_weak_explicit(&self->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The cell still holds the element from the previous lap
+            return ERR_FULL;
+        } else {
+            pos = atomic_load_explicit(&self->tail, memory_order_relaxed);
+        }
+    }
+    cell->data = data;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return OK;
+}
+
+// Function to claim the head cell and take its element, without waking anyone
+static int mpmc_queue_dequeue(MpmcQueue* self, void** data) {
+    size_t pos = atomic_load_explicit(&self->head, memory_order_relaxed);
+    MpmcQueueCell* cell;
+
+    for (;;) {
+        cell = &self->cells[pos & (self->capacity - 1)];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&self->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // No producer has filled the cell on this lap yet
+            return ERR_NIL;
+        } else {
+            pos = atomic_load_explicit(&self->head, memory_order_relaxed);
+        }
+    }
+    *data = cell->data;
+    // Hand the cell to the producer of the next lap
+    atomic_store_explicit(&cell->seq, pos + self->capacity, memory_order_release);
+    return OK;
+}
+
+// Function to wake one sleeper of the other side when there is one.
+// The fence pairs with the one taken before sleeping: either the sleeper sees the cell
+// this thread just published, or this thread sees the sleeper's waiter count.
+static inline void mpmc_queue_wake(MpmcQueue* self, atomic_size_t* waiters, pthread_cond_t* cond) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiters, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&self->lock);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&self->lock);
+    }
+}
+
+// Function to push an element without blocking
+int mpmc_queue_try_push(MpmcQueue* self, void* data) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    if (mpmc_queue_enqueue(self, data) != OK) {
+        return ERR_FULL;
+    }
+    mpmc_queue_wake(self, &self->pop_waiters, &self->not_empty);
+    return OK;
+}
+
+// Function to pop an element without blocking
+int mpmc_queue_try_pop(MpmcQueue* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    if (mpmc_queue_dequeue(self, data) != OK) {
+        return ERR_NIL;
+    }
+    mpmc_queue_wake(self, &self->push_waiters, &self->not_full);
+    return OK;
+}
+
+// Function to push an element, waiting while the queue is full
+int mpmc_queue_push(MpmcQueue* self, void* data) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    int ret;
+
+    for (unsigned spins = 0; (ret = mpmc_queue_enqueue(self, data)) != OK; spins++) {
+        if (spins < MPMC_QUEUE_SPINS) {
+            continue;
+        }
+        if (spins < MPMC_QUEUE_SPINS + MPMC_QUEUE_YIELDS) {
+            // Let the other side run, which also lets it make progress when both share a CPU
+            sched_yield();
+            continue;
+        }
+        pthread_mutex_lock(&self->lock);
+        atomic_fetch_add_explicit(&self->push_waiters, 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        // Retry once registered, a consumer that freed a cell before now did not see us waiting
+        if ((ret = mpmc_queue_enqueue(self, data)) != OK) {
+            pthread_cond_wait(&self->not_full, &self->lock);
+        }
+        atomic_fetch_sub_explicit(&self->push_waiters, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&self->lock);
+        if (ret == OK) {
+            break;
+        }
+    }
+    mpmc_queue_wake(self, &self->pop_waiters, &self->not_empty);
+    return OK;
+}
+
+// Function to pop an element, waiting while the queue is empty
+int mpmc_queue_pop(MpmcQueue* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    int ret;
+
+    for (unsigned spins = 0; (ret = mpmc_queue_dequeue(self, data)) != OK; spins++) {
+        if (spins < MPMC_QUEUE_SPINS) {
+            continue;
+        }
+        if (spins < MPMC_QUEUE_SPINS + MPMC_QUEUE_YIELDS) {
+            // Let the other side run, which also lets it make progress when both share a CPU
+            sched_yield();
+            continue;
+        }
+        pthread_mutex_lock(&self->lock);
+        atomic_fetch_add_explicit(&self->pop_waiters, 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        if ((ret = mpmc_queue_dequeue(self, data)) != OK) {
+            pthread_cond_wait(&self->not_empty, &self->lock);
+        }
+        atomic_fetch_sub_explicit(&self->pop_waiters, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&self->lock);
+        if (ret == OK) {
+            break;
+        }
+    }
+    mpmc_queue_wake(self, &self->push_waiters, &self->not_full);
+    return OK;
+}
+
+// Function to get the number of elements in the queue
+size_t mpmc_queue_length(MpmcQueue* self) {
+    return_val_if_fail(self != NULL, 0);
+    size_t head = atomic_load_explicit(&self->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&self->tail, memory_order_acquire);
+    // Reading head first keeps tail - head from going negative; a stale head can only overstate it
+    size_t size = tail - head;
+    return size < self->capacity ? size : self->capacity;
+}
+
+// Function to destroy the queue and the elements left in it
+void mpmc_queue_destroy(MpmcQueue* self) {
+    if (self != NULL) {
+        size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+        if (self->data_destroy != NULL) {
+            for (; head != tail; head++) {
+                self->data_destroy(self->data_destroy_ctx, self->cells[head & (self->capacity - 1)].data);
+            }
+        }
+        pthread_cond_destroy(&self->not_empty);
+        pthread_cond_destroy(&self->not_full);
+        pthread_mutex_destroy(&self->lock);
+        void* mem = self->mem;
+        STL_FREE(self->cells);
+        STL_FREE(mem);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "typedef.h"
+
+#define MPMC_QUEUE_CACHE_LINE 64
+
+// Structure representing one slot of an MPMC queue.
+// seq tells which lap of the ring the slot is ready for: a producer may fill it when
+// seq equals its position, a consumer may empty it when seq equals its position + 1.
+typedef struct {
+    atomic_size_t seq;
+    void* data;
+} MpmcQueueCell;
+
+// Structure representing a bounded multi-producer/multi-consumer queue (Vyukov's algorithm).
+// try_push and try_pop never lock; the blocking variants spin briefly and then sleep
+// on a condition variable that the other side only signals when someone is asleep.
+typedef struct {
+    _Alignas(MPMC_QUEUE_CACHE_LINE) atomic_size_t tail;     // Next position to push, shared by producers
+    _Alignas(MPMC_QUEUE_CACHE_LINE) atomic_size_t head;     // Next position to pop, shared by consumers
+    _Alignas(MPMC_QUEUE_CACHE_LINE) atomic_size_t push_waiters; // Producers asleep in mpmc_queue_push
+    atomic_size_t pop_waiters;                              // Consumers asleep in mpmc_queue_pop
+    _Alignas(MPMC_QUEUE_CACHE_LINE) MpmcQueueCell* cells;   // Ring of capacity cells
+    size_t capacity;                                        // Number of cells, a power of two
+    DataDestroyFunc data_destroy;                           // Function to destroy elements left at destruction
+    void* data_destroy_ctx;                                 // Context for data destruction
+    pthread_mutex_t lock;                                   // Protects sleeping only, never the ring
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+    void* mem;                                              // Allocation the aligned queue lives in
+} MpmcQueue;
+
+// Function to create a queue holding up to capacity elements (rounded up to a power of two)
+MpmcQueue* mpmc_queue_create(size_t capacity, DataDestroyFunc data_destroy, void* ctx);
+
+// Function to push an element without blocking, returns ERR_FULL when the queue is full
+int mpmc_queue_try_push(MpmcQueue* self, void* data);
+
+// Function to pop an element without blocking, returns ERR_NIL when the queue is empty
+int mpmc_queue_try_pop(MpmcQueue* self, void** data);
+
+// Function to push an element, waiting while the queue is full
+int mpmc_queue_push(MpmcQueue* self, void* data);
+
+// Function to pop an element, waiting while the queue is empty
+int mpmc_queue_pop(MpmcQueue* self, void** data);
+
+// Function to get the number of elements in the queue, a snapshot while other threads run
+size_t mpmc_queue_length(MpmcQueue* self);
+
+// Function to destroy the queue and the elements left in it, once no thread uses it
+void mpmc_queue_destroy(MpmcQueue* self);
+
+#endif /*MPMC_QUEUE_H*/
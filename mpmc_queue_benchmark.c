@@ -0,0 +1,121 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mpmc_queue.h"
+#include "queue.h"
+
+#define MAX_THREADS 16
+
+// Structure representing the shared state of one benchmark run
+typedef struct {
+    MpmcQueue *queue;       // Queue under test, NULL to use locked instead
+    Queue *locked;          // Baseline queue guarded by lock
+    pthread_mutex_t lock;
+    size_t per_thread;      // Elements each producer pushes and each consumer pops
+} Bench;
+
+// Structure representing one benchmark thread
+typedef struct {
+    Bench *bench;
+    size_t id;
+    uint64_t sum;           // Sum of the elements a consumer received
+} Worker;
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to push this producer's share of elements
+static void *producer_run(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Bench *bench = worker->bench;
+    for (size_t i = 1; i <= bench->per_thread; i++) {
+        if (bench->queue != NULL) {
+            mpmc_queue_push(bench->queue, (void *)i);
+        } else {
+            pthread_mutex_lock(&bench->lock);
+            queue_push(bench->locked, (void *)i);
+            pthread_mutex_unlock(&bench->lock);
+        }
+    }
+    return NULL;
+}
+
+// Function to pop this consumer's share of elements
+static void *consumer_run(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Bench *bench = worker->bench;
+    for (size_t i = 0; i < bench->per_thread;) {
+        void *data = NULL;
+        if (bench->queue != NULL) {
+            mpmc_queue_pop(bench->queue, &data);
+        } else {
+            pthread_mutex_lock(&bench->lock);
+            queue_pop_n(bench->locked, &data, 1);
+            pthread_mutex_unlock(&bench->lock);
+            if (data == NULL) {
+                sched_yield();
+                continue;
+            }
+        }
+        worker->sum += (uintptr_t)data;
+        i++;
+    }
+    return NULL;
+}
+
+// Function to measure throughput with thread_n producers and thread_n consumers, in million elements per second
+static double bench_run(BOOL mpmc, size_t thread_n, size_t n, BOOL *check) {
+    Bench bench;
+    pthread_t threads[2 * MAX_THREADS];
+    Worker workers[2 * MAX_THREADS];
+    uint64_t sum = 0;
+
+    bench.queue = mpmc ? mpmc_queue_create(1024, NULL, NULL) : NULL;
+    bench.locked = mpmc ? NULL : queue_create(NULL, NULL);
+    pthread_mutex_init(&bench.lock, NULL);
+    bench.per_thread = n / thread_n;
+
+    double start = now_ns();
+    for (size_t t = 0; t < 2 * thread_n; t++) {
+        workers[t].bench = &bench;
+        workers[t].id = t;
+        workers[t].sum = 0;
+        pthread_create(&threads[t], NULL, t < thread_n ? producer_run : consumer_run, &workers[t]);
+    }
+    for (size_t t = 0; t < 2 * thread_n; t++) {
+        pthread_join(threads[t], NULL);
+        sum += workers[t].sum;
+    }
+    double elapsed = now_ns() - start;
+
+    *check = sum == (uint64_t)thread_n * bench.per_thread * (bench.per_thread + 1) / 2;
+    mpmc_queue_destroy(bench.queue);
+    queue_destroy(bench.locked);
+    pthread_mutex_destroy(&bench.lock);
+    return (double)(bench.per_thread * thread_n) / elapsed * 1e3;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : MAX_THREADS;
+    max_threads = max_threads > MAX_THREADS ? MAX_THREADS : max_threads;
+
+    printf("%zu elements, N producers and N consumers (Melem/s)\n", n);
+    printf("%-8s %12s %12s %9s %8s\n", "N", "mutex+Queue", "mpmc", "speedup", "check");
+    for (size_t thread_n = 1; thread_n <= max_threads; thread_n *= 2) {
+        BOOL locked_ok = FALSE;
+        BOOL mpmc_ok = FALSE;
+        double locked = bench_run(FALSE, thread_n, n, &locked_ok);
+        double mpmc = bench_run(TRUE, thread_n, n, &mpmc_ok);
+        printf("%-8zu %12.2f %12.2f %8.2fx %8s\n", thread_n, locked, mpmc, mpmc / locked,
+               locked_ok && mpmc_ok ? "ok" : "MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,270 @@
+#include <stdlib.h>
+#include "priority_queue.h"
+#include "sort.h"
+
+// Function to compare two elements through the user comparator, like array_sort does
+static inline int priority_queue_cmp(PriorityQueue* self, void* a, void* b) {
+    return ((SortCmpFunc)self->cmp)(a, b);
+}
+
+// Function to store an element at index and tell the index function where it went
+static inline void priority_queue_place(PriorityQueue* self, size_t index, void* data) {
+    self->array->data[index] = data;
+    if (self->index != NULL) {
+        self->index(self->index_ctx, data, index);
+    }
+}
+
+// Function to move the element at index up until its parent is not larger
+static void priority_queue_sift_up(PriorityQueue* self, size_t index) {
+    void** data = self->array->data;
+    void* current = data[index];
+
+    // Parents move down into the hole, so current is written only once
+    while (index > 0) {
+        size_t parent = (index - 1) / self->arity;
+        if (priority_queue_cmp(self, current, data[parent]) >= 0) {
+            break;
+        }
+        priority_queue_place(self, index, data[parent]);
+        index = parent;
+    }
+    priority_queue_place(self, index, current);
+}
+
+// Function to move the element at index down until no child is smaller
+static void priority_queue_sift_down(PriorityQueue* self, size_t index) {
+    void** data = self->array->data;
+    size_t size = self->array->size;
+    size_t arity = self->arity;
+    void* current = data[index];
+
+    for (;;) {
+        size_t first = index * arity + 1;
+        if (first >= size) {
+            break;
+        }
+        size_t last = first + arity < size ? first + arity : size;
+        size_t min = first;
+        for (size_t child = first + 1; child < last; child++) {
+            if (priority_queue_cmp(self, data[child], data[min]) < 0) {
+                min = child;
+            }
+        }
+        if (priority_queue_cmp(self, data[min], current) >= 0) {
+            break;
+        }
+        priority_queue_place(self, index, data[min]);
+        index = min;
+    }
+    priority_queue_place(self, index, current);
+}
+
+// Function to restore the heap order of the whole array bottom-up in O(n)
+static void priority_queue_heapify(PriorityQueue* self) {
+    size_t size = self->array->size;
+
+    if (size > 1) {
+        for (size_t i = (size - 2) / self->arity + 1; i > 0; i--) {
+            priority_queue_sift_down(self, i - 1);
+        }
+    }
+}
+
+// Function to allocate a queue around an array that already holds its elements
+static PriorityQueue* priority_queue_alloc(Array* array, DataCompareFunc cmp, size_t arity) {
+    PriorityQueue* self = (PriorityQueue*)STL_MALLOC(sizeof(PriorityQueue));
+    if (self != NULL) {
+        self->array = array;
+        self->arity = arity == 0 ? PRIORITY_QUEUE_ARITY : arity;
+        self->cmp = cmp;
+        self->index = NULL;
+        self->index_ctx = NULL;
+        self->data_destroy = NULL;
+        self->data_destroy_ctx = NULL;
+    }
+    return self;
+}
+
+// Function to create an empty priority queue whose nodes have arity children (0 picks PRIORITY_QUEUE_ARITY)
+PriorityQueue* priority_queue_create(DataCompareFunc cmp, size_t arity, DataDestroyFunc data_destroy, void* ctx) {
+    return_val_if_fail(cmp != NULL && arity != 1, NULL);
+    Array* array = array_create(NULL, NULL);
+    if (array == NULL || array->data == NULL) {
+        array_destroy(array);
+        return NULL;
+    }
+
+    PriorityQueue* self = priority_queue_alloc(array, cmp, arity);
+    if (self == NULL) {
+        array_destroy(array);
+        return NULL;
+    }
+    self->data_destroy = data_destroy;
+    self->data_destroy_ctx = ctx;
+    return self;
+}
+
+// Function to turn an array into a priority queue in O(n), taking ownership of the array and its destroy function
+PriorityQueue* priority_queue_from_array(Array* array, DataCompareFunc cmp, size_t arity) {
+    return_val_if_fail(array != NULL && array->elem_size == 0 && cmp != NULL && arity != 1, NULL);
+    PriorityQueue* self = priority_queue_alloc(array, cmp, arity);
+    if (self != NULL) {
+        // The queue destroys elements itself, so popping the array's last slot must not
+        self->data_destroy = array->data_destroy;
+        self->data_destroy_ctx = array->data_destroy_ctx;
+        array->data_destroy = NULL;
+        array->data_destroy_ctx = NULL;
+        priority_queue_heapify(self);
+    }
+    return self;
+}
+
+// Function to set the function told of every element's index, called at once for the elements already queued
+int priority_queue_set_index_func(PriorityQueue* self, PriorityQueueIndexFunc index, void* ctx) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    self->index = index;
+    self->index_ctx = ctx;
+    if (index != NULL) {
+        for (size_t i = 0; i < self->array->size; i++) {
+            index(ctx, self->array->data[i], i);
+        }
+    }
+    return OK;
+}
+
+// Function to push an element into the queue
+int priority_queue_push(PriorityQueue* self, void* data) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    if (array_append(self->array, data) != OK) {
+        return ERR_OOM;
+    }
+    priority_queue_sift_up(self, self->array->size - 1);
+    return OK;
+}
+
+// Function to push n elements, rebuilding the heap in O(size + n) when that beats sifting each one up
+int priority_queue_push_n(PriorityQueue* self, void** data, size_t n) {
+    return_val_if_fail(self != NULL && (data != NULL || n == 0), ERR_NIL);
+    size_t size = self->array->size;
+
+    // Sifting up costs about log(size) per element against a rebuild touching every element,
+    // so rebuild once the batch is a sizeable share of the queue
+    if (n < 8 || n < size / 8) {
+        for (size_t i = 0; i < n; i++) {
+            if (priority_queue_push(self, data[i]) != OK) {
+                return ERR_OOM;
+            }
+        }
+        return OK;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (array_append(self->array, data[i]) != OK) {
+            // Leave the queue as it was before the call
+            self->array->size = size;
+            return ERR_OOM;
+        }
+    }
+    priority_queue_heapify(self);
+    if (self->index != NULL) {
+        // Sifting only reports the elements it moved, the new ones may not have moved at all
+        for (size_t i = size; i < self->array->size; i++) {
+            self->index(self->index_ctx, self->array->data[i], i);
+        }
+    }
+    return OK;
+}
+
+// Function to get the smallest element without removing it
+int priority_queue_top(PriorityQueue* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    if (self->array->size == 0) {
+        return ERR_NIL;
+    }
+    *data = self->array->data[0];
+    return OK;
+}
+
+// Function to pop the smallest element and destroy it
+int priority_queue_pop(PriorityQueue* self) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    if (self->array->size == 0) {
+        return ERR_NIL;
+    }
+    return priority_queue_remove(self, 0, NULL);
+}
+
+// Function to pop the smallest element into data; ownership passes to the caller, it is not destroyed
+int priority_queue_pop_into(PriorityQueue* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    if (self->array->size == 0) {
+        return ERR_NIL;
+    }
+    return priority_queue_remove(self, 0, data);
+}
+
+// Function to restore the heap order after the priority of the element at index changed in either direction
+int priority_queue_update(PriorityQueue* self, size_t index) {
+    return_val_if_fail(self != NULL && index < self->array->size, ERR_NIL);
+    void** data = self->array->data;
+
+    if (index > 0 && priority_queue_cmp(self, data[index], data[(index - 1) / self->arity]) < 0) {
+        priority_queue_sift_up(self, index);
+    } else {
+        priority_queue_sift_down(self, index);
+    }
+    return OK;
+}
+
+// Function to remove the element at index, handing it to data, or destroying it when data is NULL
+int priority_queue_remove(PriorityQueue* self, size_t index, void** data) {
+    return_val_if_fail(self != NULL && index < self->array->size, ERR_NIL);
+    Array* array = self->array;
+    void* removed = array->data[index];
+    size_t last = array->size - 1;
+
+    // Fill the hole with the last element, then drop the last slot
+    if (index != last) {
+        array->data[index] = array->data[last];
+    }
+    array_delete(array, last);
+    if (index != last) {
+        priority_queue_update(self, index);
+    }
+
+    if (self->index != NULL) {
+        self->index(self->index_ctx, removed, PRIORITY_QUEUE_NO_INDEX);
+    }
+    if (data != NULL) {
+        *data = removed;
+    } else if (self->data_destroy != NULL) {
+        self->data_destroy(self->data_destroy_ctx, removed);
+    }
+    return OK;
+}
+
+// Function to get the number of elements in the queue
+size_t priority_queue_length(PriorityQueue* self) {
+    return_val_if_fail(self != NULL, 0);
+    return self->array->size;
+}
+
+// Function to apply a visit function to each element in heap (not sorted) order
+int priority_queue_foreach(PriorityQueue* self, DataVisitFunc visit, void* ctx) {
+    return_val_if_fail(self != NULL && visit != NULL, ERR_NIL);
+    return array_foreach(self->array, visit, ctx);
+}
+
+// Function to destroy the queue and the elements left in it
+void priority_queue_destroy(PriorityQueue* self) {
+    if (self != NULL) {
+        if (self->data_destroy != NULL) {
+            for (size_t i = 0; i < self->array->size; i++) {
+                self->data_destroy(self->data_destroy_ctx, self->array->data[i]);
+            }
+        }
+        array_destroy(self->array);
+        STL_FREE(self);
+    }
+}
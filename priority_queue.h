@@ -0,0 +1,69 @@
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <stdio.h>
+#include "typedef.h"
+#include "array.h"
+
+// Index reported to the index function for an element that has left the queue
+#define PRIORITY_QUEUE_NO_INDEX ((size_t)-1)
+
+// Number of children per node used when priority_queue_create is given an arity of 0
+#define PRIORITY_QUEUE_ARITY 4
+
+// Function pointer type told the current index of an element every time the queue moves it.
+// Keeping that index next to the element gives a handle for priority_queue_update and priority_queue_remove.
+typedef void (*PriorityQueueIndexFunc)(void* ctx, void* data, size_t index);
+
+// Structure representing a priority queue, a d-ary min-heap stored in an Array
+typedef struct {
+    Array* array;                   // Heap ordered elements; the array itself destroys nothing
+    size_t arity;                   // Number of children per node, 2 or more
+    DataCompareFunc cmp;            // Called as cmp(a, b) like array_sort, negative when a comes first
+    PriorityQueueIndexFunc index;   // Function told where elements move to, may be NULL
+    void* index_ctx;                // Context for the index function
+    DataDestroyFunc data_destroy;   // Function to destroy elements popped or left at destruction
+    void* data_destroy_ctx;         // Context for data destruction
+} PriorityQueue;
+
+// Function to create an empty priority queue whose nodes have arity children (0 picks PRIORITY_QUEUE_ARITY)
+PriorityQueue* priority_queue_create(DataCompareFunc cmp, size_t arity, DataDestroyFunc data_destroy, void* ctx);
+
+// Function to turn an array into a priority queue in O(n), taking ownership of the array and its destroy function.
+// The array must store pointers, not inline elements.
+PriorityQueue* priority_queue_from_array(Array* array, DataCompareFunc cmp, size_t arity);
+
+// Function to set the function told of every element's index, called at once for the elements already queued
+int priority_queue_set_index_func(PriorityQueue* self, PriorityQueueIndexFunc index, void* ctx);
+
+// Function to push an element into the queue
+int priority_queue_push(PriorityQueue* self, void* data);
+
+// Function to push n elements, rebuilding the heap in O(size + n) when that beats sifting each one up
+int priority_queue_push_n(PriorityQueue* self, void** data, size_t n);
+
+// Function to get the smallest element without removing it
+int priority_queue_top(PriorityQueue* self, void** data);
+
+// Function to pop the smallest element and destroy it
+int priority_queue_pop(PriorityQueue* self);
+
+// Function to pop the smallest element into data; ownership passes to the caller, it is not destroyed
+int priority_queue_pop_into(PriorityQueue* self, void** data);
+
+// Function to restore the heap order after the priority of the element at index changed in either direction
+int priority_queue_update(PriorityQueue* self, size_t index);
+
+// Function to remove the element at index, handing it to data, or destroying it when data is NULL
+int priority_queue_remove(PriorityQueue* self, size_t index, void** data);
+
+// Function to get the number of elements in the queue
+size_t priority_queue_length(PriorityQueue* self);
+
+// Function to apply a visit function to each element in heap (not sorted) order
+int priority_queue_foreach(PriorityQueue* self, DataVisitFunc visit, void* ctx);
+
+// Function to destroy the queue and the elements left in it
+void priority_queue_destroy(PriorityQueue* self);
+
+#endif /*PRIORITY_QUEUE_H*/
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "array.h"
+#include "priority_queue.h"
+
+// Number of elements pushed, then popped, per round of the steady state benchmark
+#define BATCH 16
+
+// Structure representing a queued task with a priority and its position in the heap
+typedef struct {
+    int key;
+    size_t index;
+} Task;
+
+// Comparison function ordering tasks by ascending key
+int task_cmp(void *i, void *j) {
+    int a = ((Task*)i)->key;
+    int b = ((Task*)j)->key;
+    return (a > b) - (a < b);
+}
+
+// Comparison function ordering tasks by descending key, so a sorted array pops its minimum from the end
+int task_cmp_desc(void *i, void *j) {
+    return task_cmp(j, i);
+}
+
+// Index function keeping each task's heap position up to date
+void task_index(void *ctx, void *data, size_t index) {
+    ((Task*)data)->index = index;
+}
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to run rounds of BATCH pushes and BATCH pops over size queued tasks on an array re-sorted after every batch
+static double bench_sorted_array(Task *tasks, size_t size, size_t rounds) {
+    Array *array = array_create(NULL, NULL);
+    Task *spare[BATCH];
+    long sum = 0;
+    for (size_t i = 0; i < BATCH; i++) {
+        spare[i] = &tasks[size + i];
+    }
+    for (size_t i = 0; i < size; i++) {
+        array_append(array, &tasks[i]);
+    }
+    array_sort(array, (DataCompareFunc)task_cmp_desc, NULL);
+
+    double start = now_ns();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < BATCH; i++) {
+            Task *task = spare[i];
+            task->key = rand();
+            array_append(array, task);
+        }
+        array_sort(array, (DataCompareFunc)task_cmp_desc, NULL);
+        for (size_t i = 0; i < BATCH; i++) {
+            void *data = NULL;
+            array_get_by_index(array, array_length(array) - 1, &data);
+            sum += ((Task*)data)->key & 1;
+            array_delete(array, array_length(array) - 1);
+            // Popped tasks are pushed again with new keys in the next round
+            spare[i] = (Task*)data;
+        }
+    }
+    double ns = (now_ns() - start) / (double)(rounds * BATCH * 2);
+    array_destroy(array);
+    return sum >= 0 ? ns : 0;
+}
+
+// Function to run the same rounds on a priority queue with the given arity
+static double bench_heap(Task *tasks, size_t size, size_t rounds, size_t arity) {
+    PriorityQueue *queue = priority_queue_create((DataCompareFunc)task_cmp, arity, NULL, NULL);
+    Task *spare[BATCH];
+    long sum = 0;
+    for (size_t i = 0; i < BATCH; i++) {
+        spare[i] = &tasks[size + i];
+    }
+    for (size_t i = 0; i < size; i++) {
+        priority_queue_push(queue, &tasks[i]);
+    }
+
+    double start = now_ns();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < BATCH; i++) {
+            Task *task = spare[i];
+            task->key = rand();
+            priority_queue_push(queue, task);
+        }
+        for (size_t i = 0; i < BATCH; i++) {
+            void *data = NULL;
+            priority_queue_pop_into(queue, &data);
+            sum += ((Task*)data)->key & 1;
+            spare[i] = (Task*)data;
+        }
+    }
+    double ns = (now_ns() - start) / (double)(rounds * BATCH * 2);
+    priority_queue_destroy(queue);
+    return sum >= 0 ? ns : 0;
+}
+
+// Function to time building an ordered container from n tasks: array_sort, or heapify with the given arity
+static double bench_build(Task *tasks, size_t n, size_t arity) {
+    Array *array = array_create(NULL, NULL);
+    for (size_t i = 0; i < n; i++) {
+        tasks[i].key = rand();
+        array_append(array, &tasks[i]);
+    }
+
+    double start = now_ns();
+    if (arity == 0) {
+        array_sort(array, (DataCompareFunc)task_cmp, NULL);
+        double ns = (now_ns() - start) / (double)n;
+        array_destroy(array);
+        return ns;
+    }
+    PriorityQueue *queue = priority_queue_from_array(array, (DataCompareFunc)task_cmp, arity);
+    double ns = (now_ns() - start) / (double)n;
+    priority_queue_destroy(queue);
+    return ns;
+}
+
+// Function to time decrease-key on n queued tasks through the handles kept by the index function
+static double bench_decrease_key(Task *tasks, size_t n, size_t ops, size_t arity) {
+    PriorityQueue *queue = priority_queue_create((DataCompareFunc)task_cmp, arity, NULL, NULL);
+    priority_queue_set_index_func(queue, task_index, NULL);
+    for (size_t i = 0; i < n; i++) {
+        tasks[i].key = rand();
+        priority_queue_push(queue, &tasks[i]);
+    }
+
+    double start = now_ns();
+    for (size_t i = 0; i < ops; i++) {
+        Task *task = &tasks[(size_t)rand() % n];
+        task->key -= task->key / 4 + 1;
+        priority_queue_update(queue, task->index);
+    }
+    double ns = (now_ns() - start) / (double)ops;
+    priority_queue_destroy(queue);
+    return ns;
+}
+
+int main(int argc, char *argv[]) {
+    size_t max = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    Task *tasks = (Task*)malloc((max + BATCH) * sizeof(Task));
+
+    printf("steady state: push %d then pop %d per round, ns per operation\n", BATCH, BATCH);
+    printf("%-10s %14s %12s %12s\n", "queued", "array_sort", "binary", "4-ary");
+    for (size_t n = 1000; n <= max; n *= 10) {
+        // Re-sorting costs O(n log n) per round, so it gets fewer rounds as n grows
+        size_t sort_rounds = n <= 10000 ? 2000 : 20;
+        double ns[3];
+        for (size_t k = 0; k < 3; k++) {
+            srand(1);
+            for (size_t i = 0; i < n; i++) {
+                tasks[i].key = rand();
+            }
+            ns[k] = k == 0 ? bench_sorted_array(tasks, n, sort_rounds) : bench_heap(tasks, n, 100000, k * 2);
+        }
+        printf("%-10zu %14.1f %12.1f %12.1f\n", n, ns[0], ns[1], ns[2]);
+    }
+
+    printf("\nbuild from %zu elements, ns per element\n", max);
+    printf("%-14s %12s %12s\n", "array_sort", "heapify 2", "heapify 4");
+    printf("%-14.1f %12.1f %12.1f\n", bench_build(tasks, max, 0), bench_build(tasks, max, 2),
+           bench_build(tasks, max, 4));
+
+    printf("\ndecrease-key over %zu queued elements, ns per update\n", max);
+    printf("%-14s %12s\n", "binary", "4-ary");
+    printf("%-14.1f %12.1f\n", bench_decrease_key(tasks, max, 1000000, 2), bench_decrease_key(tasks, max, 1000000, 4));
+
+    free(tasks);
+    return 0;
+}
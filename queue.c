@@ -1,54 +1,177 @@
+#include <stdint.h>
+#include <string.h>
 #include "queue.h"
 #include "typedef.h"
-#include "list.h"
+
+#define MIN_SIZE 16
 
 // Function to create a new queue
 Queue* queue_create(DataDestroyFunc data_destroy, void* ctx) {
     Queue* self = (Queue*)STL_MALLOC(sizeof(Queue));
     if (self != NULL) {
-        if ((self->list = list_create(data_destroy, ctx)) == NULL) {
+        if ((self->data = (void**)STL_MALLOC(MIN_SIZE * sizeof(void*))) == NULL) {
             STL_FREE(self);
             self = NULL;
+        } else {
+            self->head = 0;
+            self->size = 0;
+            self->alloc_size = MIN_SIZE;
+            self->data_destroy = data_destroy;
+            self->data_destroy_ctx = ctx;
         }
     }
     return self;
 }
 
+// Function to move the elements into a new buffer of alloc_size slots, unwrapping them to start at index 0
+static int queue_resize(Queue* self, size_t alloc_size) {
+    void** data = (void**)STL_MALLOC(alloc_size * sizeof(void*));
+    if (data == NULL) {
+        return ERR_OOM;
+    }
+
+    // The elements occupy at most two runs: head to the end of the buffer, then its start
+    size_t first = self->alloc_size - self->head;
+    first = first < self->size ? first : self->size;
+    memcpy(data, self->data + self->head, first * sizeof(void*));
+    memcpy(data + first, self->data, (self->size - first) * sizeof(void*));
+
+    STL_FREE(self->data);
+    self->data = data;
+    self->head = 0;
+    self->alloc_size = alloc_size;
+    return OK;
+}
+
+// Function to make room for n more elements, doubling the buffer as needed
+static int queue_reserve(Queue* self, size_t n) {
+    size_t alloc_size = self->alloc_size;
+    // Neither the element count, its byte size nor the doubling below may overflow
+    if (n > SIZE_MAX / sizeof(void*) - self->size) {
+        return ERR_OOM;
+    }
+    if (self->size + n <= alloc_size) {
+        return OK;
+    }
+    while (self->size + n > alloc_size) {
+        if (alloc_size > SIZE_MAX / sizeof(void*) / 2) {
+            return ERR_OOM;
+        }
+        alloc_size <<= 1;
+    }
+    return queue_resize(self, alloc_size);
+}
+
+// Function to halve the buffer once the queue uses a quarter of it, so a drained burst releases its memory
+static void queue_shrink(Queue* self) {
+    if (self->alloc_size > MIN_SIZE && self->size <= (self->alloc_size >> 2)) {
+        // A failed shrink leaves the larger buffer in place, which is still valid
+        queue_resize(self, self->alloc_size >> 1);
+    }
+}
+
 // Function to get the element at the head of the queue without removing it
 int queue_head(Queue* self, void** data) {
     return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
-    return list_get_by_index(self->list, 0, data);
+    if (self->size == 0) {
+        return ERR_NIL;
+    }
+    *data = self->data[self->head];
+    return OK;
 }
 
 // Function to push (enqueue) an element to the end of the queue
 int queue_push(Queue* self, void* data) {
     return_val_if_fail(self != NULL, ERR_NIL);
-    return list_append(self->list, data);
+    if (self->size == self->alloc_size && queue_reserve(self, 1) != OK) {
+        return ERR_OOM;
+    }
+    self->data[(self->head + self->size) & (self->alloc_size - 1)] = data;
+    self->size++;
+    return OK;
+}
+
+// Function to push n elements to the end of the queue, in order
+int queue_push_n(Queue* self, void** data, size_t n) {
+    return_val_if_fail(self != NULL && (data != NULL || n == 0), ERR_NIL);
+    if (n == 0) {
+        return OK;
+    }
+    if (queue_reserve(self, n) != OK) {
+        return ERR_OOM;
+    }
+
+    // Copy up to the end of the buffer, then wrap to its start
+    size_t tail = (self->head + self->size) & (self->alloc_size - 1);
+    size_t first = self->alloc_size - tail;
+    first = first < n ? first : n;
+    memcpy(self->data + tail, data, first * sizeof(void*));
+    memcpy(self->data, data + first, (n - first) * sizeof(void*));
+    self->size += n;
+    return OK;
 }
 
 // Function to pop (dequeue) an element from the front of the queue
 int queue_pop(Queue* self) {
     return_val_if_fail(self != NULL, ERR_NIL);
-    return list_delete(self->list, 0);
+    if (self->size == 0) {
+        return ERR_NIL;
+    }
+
+    void* data = self->data[self->head];
+    self->head = (self->head + 1) & (self->alloc_size - 1);
+    self->size--;
+    if (self->data_destroy != NULL) {
+        self->data_destroy(self->data_destroy_ctx, data);
+    }
+    queue_shrink(self);
+    return OK;
+}
+
+// Function to pop up to n elements from the front of the queue, handing them to the caller
+size_t queue_pop_n(Queue* self, void** data, size_t n) {
+    return_val_if_fail(self != NULL && (data != NULL || n == 0), 0);
+    n = n < self->size ? n : self->size;
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t first = self->alloc_size - self->head;
+    first = first < n ? first : n;
+    memcpy(data, self->data + self->head, first * sizeof(void*));
+    memcpy(data + first, self->data, (n - first) * sizeof(void*));
+    self->head = (self->head + n) & (self->alloc_size - 1);
+    self->size -= n;
+    queue_shrink(self);
+    return n;
 }
 
 // Function to get the current length (number of elements) in the queue
 size_t queue_length(Queue* self) {
     return_val_if_fail(self != NULL, 0);
-    return list_length(self->list);
+    return self->size;
 }
 
-// Function to apply a visit function to each element in the queue
+// Function to apply a visit function to each element in the queue, from head to tail
 int queue_foreach(Queue* self, DataVisitFunc visit, void* ctx) {
     return_val_if_fail(self != NULL && visit != NULL, ERR_NIL);
-    return list_foreach(self->list, visit, ctx);
+    for (size_t i = 0; i < self->size; i++) {
+        if (!visit(ctx, i, self->data[(self->head + i) & (self->alloc_size - 1)])) {
+            break;
+        }
+    }
+    return OK;
 }
 
 // Function to destroy the queue
 void queue_destroy(Queue* self) {
     if (self != NULL) {
-        list_destroy(self->list);
-        self->list = NULL;
+        if (self->data_destroy != NULL) {
+            for (size_t i = 0; i < self->size; i++) {
+                self->data_destroy(self->data_destroy_ctx, self->data[(self->head + i) & (self->alloc_size - 1)]);
+            }
+        }
+        STL_FREE(self->data);
         STL_FREE(self);
     }
     return;
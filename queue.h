@@ -3,11 +3,15 @@
 
 #include <stdio.h>
 #include "typedef.h"
-#include "list.h"
 
-// Structure representing a Queue
+// Structure representing a Queue, a growable ring buffer of element pointers
 typedef struct {
-    List* list; // The underlying list to store queue elements
+    void** data;                    // Ring buffer, alloc_size is a power of two
+    size_t head;                    // Index of the head element in data
+    size_t size;                    // Number of elements in the queue
+    size_t alloc_size;              // Number of slots in data
+    DataDestroyFunc data_destroy;   // Function to destroy elements popped or left at destruction
+    void* data_destroy_ctx;         // Context for data destruction
 } Queue;
 
 // Function to create a new queue
@@ -19,15 +23,23 @@ int queue_head(Queue* thiz, void** data);
 // Function to push (enqueue) an element to the end of the queue
 int queue_push(Queue* thiz, void* data);
 
+// Function to push n elements to the end of the queue, in order
+int queue_push_n(Queue* thiz, void** data, size_t n);
+
 // Function to pop (dequeue) an element from the front of the queue
 int queue_pop(Queue* thiz);
 
+// Function to pop up to n elements from the front of the queue into data, returning how many were popped.
+// Ownership of the popped elements passes to the caller, they are not destroyed.
+size_t queue_pop_n(Queue* thiz, void** data, size_t n);
+
 // Function to get the current length (number of elements) in the queue
 size_t queue_length(Queue* thiz);
 
 // Function to apply a visit function to each element in the queue
 int queue_foreach(Queue* thiz, DataVisitFunc visit, void* ctx);
 
+// Function to destroy the queue
 void queue_destroy(Queue* self);
 
 #endif
\ No newline at end of file
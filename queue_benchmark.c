@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "list.h"
+#include "queue.h"
+
+// Number of elements moved per queue_push_n/queue_pop_n call
+#define BATCH 64
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to fill a list-backed queue with n elements and drain it, as queue.c did before the ring buffer
+static double bench_list(size_t n) {
+    List *list = list_create(NULL, NULL);
+    double start = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        list_append(list, (void*)(i + 1));
+    }
+    for (size_t i = 0; i < n; i++) {
+        list_delete(list, 0);
+    }
+    double ns = (now_ns() - start) / (double)n;
+    list_destroy(list);
+    return ns;
+}
+
+// Function to fill the ring buffer queue with n elements and drain it, one element per call
+static double bench_ring(size_t n) {
+    Queue *queue = queue_create(NULL, NULL);
+    double start = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        queue_push(queue, (void*)(i + 1));
+    }
+    for (size_t i = 0; i < n; i++) {
+        queue_pop(queue);
+    }
+    double ns = (now_ns() - start) / (double)n;
+    queue_destroy(queue);
+    return ns;
+}
+
+// Function to fill the ring buffer queue with n elements and drain it, BATCH elements per call
+static double bench_ring_batch(size_t n) {
+    Queue *queue = queue_create(NULL, NULL);
+    void *batch[BATCH];
+    double start = now_ns();
+    for (size_t i = 0; i < n; i += BATCH) {
+        size_t count = n - i < BATCH ? n - i : BATCH;
+        for (size_t j = 0; j < count; j++) {
+            batch[j] = (void*)(i + j + 1);
+        }
+        queue_push_n(queue, batch, count);
+    }
+    while (queue_pop_n(queue, batch, BATCH) > 0) {
+    }
+    double ns = (now_ns() - start) / (double)n;
+    queue_destroy(queue);
+    return ns;
+}
+
+int main(int argc, char *argv[]) {
+    // The list-backed queue walks to its tail on every push, so it is only run up to list_max elements
+    size_t max = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t list_max = argc > 2 ? strtoul(argv[2], NULL, 10) : 100000;
+
+    printf("fill then drain, ns per element\n");
+    printf("%-10s %12s %12s %12s\n", "n", "list", "ring", "ring batch");
+    for (size_t n = 1000; n <= max; n *= 10) {
+        if (n <= list_max) {
+            printf("%-10zu %12.1f", n, bench_list(n));
+        } else {
+            printf("%-10zu %12s", n, "-");
+        }
+        printf(" %12.1f %12.1f\n", bench_ring(n), bench_ring_batch(n));
+    }
+    return 0;
+}
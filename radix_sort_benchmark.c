@@ -0,0 +1,146 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "array.h"
+
+// Key distributions exercised by the benchmark
+typedef enum {
+    KEYS_U64,       // Random 64-bit unsigned keys, every byte varies
+    KEYS_U32,       // Random keys below 2^32, the top four bytes are skipped
+    KEYS_I64,       // Random signed keys of both signs
+    KEYS_DOUBLE,    // Random doubles of both signs
+} Keys;
+
+static const char *keys_names[] = {"u64", "u32", "i64", "double"};
+
+// Structure representing a sorted record: the key and the position it was generated at, to check stability
+typedef struct {
+    union {
+        uint64_t u;
+        int64_t i;
+        double d;
+    } key;
+    size_t seq;
+} Record;
+
+// Function to get a random 64-bit value
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = (*state += 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Comparison functions for array_sort and array_sort_stable, one per key type
+int record_cmp_u64(void *i, void *j) {
+    uint64_t a = ((Record*)i)->key.u;
+    uint64_t b = ((Record*)j)->key.u;
+    return (a > b) - (a < b);
+}
+
+int record_cmp_i64(void *i, void *j) {
+    int64_t a = ((Record*)i)->key.i;
+    int64_t b = ((Record*)j)->key.i;
+    return (a > b) - (a < b);
+}
+
+int record_cmp_double(void *i, void *j) {
+    double a = ((Record*)i)->key.d;
+    double b = ((Record*)j)->key.d;
+    return (a > b) - (a < b);
+}
+
+// Key functions for array_radix_sort, one per key type
+uint64_t record_key_u64(void *ctx, void *data) {
+    return ((Record*)data)->key.u;
+}
+
+int64_t record_key_i64(void *ctx, void *data) {
+    return ((Record*)data)->key.i;
+}
+
+double record_key_double(void *ctx, void *data) {
+    return ((Record*)data)->key.d;
+}
+
+// Function to fill the records with keys and point the array at them in generation order
+static void make_records(Array *array, Record *records, Keys keys, size_t n) {
+    uint64_t state = 42;
+    array_resize(array, n);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = next_random(&state);
+        switch (keys) {
+            case KEYS_U64:    records[i].key.u = r; break;
+            case KEYS_U32:    records[i].key.u = r >> 32; break;
+            case KEYS_I64:    records[i].key.i = (int64_t)r; break;
+            case KEYS_DOUBLE: records[i].key.d = ((double)(r >> 11) / 9007199254740992.0 - 0.5) * 1e6; break;
+        }
+        records[i].seq = i;
+        array->data[i] = &records[i];
+    }
+}
+
+// Function to check the array is sorted, and when stable is set, that equal keys kept their order
+static BOOL is_sorted(Array *array, DataCompareFunc cmp, BOOL stable) {
+    for (size_t i = 1; i < array->size; i++) {
+        Record *prev = (Record*)array->data[i - 1];
+        Record *cur = (Record*)array->data[i];
+        int c = cmp(prev, cur);
+        if (c > 0 || (stable && c == 0 && prev->seq > cur->seq)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Function to get the current monotonic time in milliseconds
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// Function to time array_sort, array_sort_stable and array_radix_sort on the same keys
+static void bench(Array *array, Record *records, Keys keys, size_t n) {
+    DataCompareFunc cmps[] = {record_cmp_u64, record_cmp_u64, record_cmp_i64, record_cmp_double};
+    DataCompareFunc cmp = cmps[keys];
+    double ms[3];
+    BOOL ok = TRUE;
+
+    for (int algo = 0; algo < 3; algo++) {
+        make_records(array, records, keys, n);
+        double start = now_ms();
+        if (algo == 0) {
+            array_sort(array, cmp, NULL);
+        } else if (algo == 1) {
+            array_sort_stable(array, cmp);
+        } else if (keys == KEYS_I64) {
+            array_radix_sort_int64(array, record_key_i64, NULL);
+        } else if (keys == KEYS_DOUBLE) {
+            array_radix_sort_double(array, record_key_double, NULL);
+        } else {
+            array_radix_sort(array, record_key_u64, NULL);
+        }
+        ms[algo] = now_ms() - start;
+        ok = ok && is_sorted(array, cmp, algo > 0);
+    }
+    printf("%-8s %12.1f %12.1f %12.1f %10.1fx %8s\n", keys_names[keys], ms[0], ms[1], ms[2], ms[0] / ms[2],
+           ok ? "ok" : "MISMATCH");
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    Array *array = array_create(NULL, NULL);
+    Record *records = (Record*)malloc(n * sizeof(Record));
+
+    printf("%zu elements, ms per sort\n", n);
+    printf("%-8s %12s %12s %12s %11s %8s\n", "keys", "sort", "stable", "radix", "speedup", "check");
+    for (int k = KEYS_U64; k <= KEYS_DOUBLE; k++) {
+        bench(array, records, (Keys)k, n);
+    }
+
+    free(records);
+    array_destroy(array);
+    return 0;
+}
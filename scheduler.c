@@ -0,0 +1,280 @@
+#include <sched.h>
+#include <unistd.h>
+#include "scheduler.h"
+
+// Initial number of slots in each worker's deque; deques grow when a task spawns deeper than that
+#define SCHEDULER_DEQUE_SIZE 256
+
+// Number of failed searches for a task an idle worker retries busily, then yielding the CPU, before going to sleep
+#define SCHEDULER_SPINS 64
+#define SCHEDULER_YIELDS 16
+
+// Worker the calling thread runs as, NULL outside the pool
+static _Thread_local SchedulerWorker* scheduler_current = NULL;
+
+// Function to run a task and mark it done; the task may be freed by its owner as soon as done is set
+static void scheduler_execute(Scheduler* self, SchedulerTask* task) {
+    task->func(task->ctx);
+    if (task->root) {
+        // The submitting thread sleeps on the done condition, so the flag is set under its lock
+        pthread_mutex_lock(&self->lock);
+        atomic_store_explicit(&task->done, 1, memory_order_release);
+        pthread_cond_broadcast(&self->done);
+        pthread_mutex_unlock(&self->lock);
+    } else {
+        atomic_store_explicit(&task->done, 1, memory_order_release);
+    }
+}
+
+// Function to find a task for a worker: its own newest, another worker's oldest, then a submitted root task
+static SchedulerTask* scheduler_find(SchedulerWorker* worker) {
+    Scheduler* self = worker->scheduler;
+    void* data = NULL;
+
+    if (work_deque_pop(worker->deque, &data) == OK) {
+        return (SchedulerTask*)data;
+    }
+    // Start at a random victim so thieves spread over the pool instead of all hitting worker 0
+    size_t start = (size_t)rand_r(&worker->seed) % self->thread_n;
+    for (size_t i = 0; i < self->thread_n; i++) {
+        size_t victim = (start + i) % self->thread_n;
+        if (victim != worker->index && work_deque_steal(self->workers[victim].deque, &data) == OK) {
+            return (SchedulerTask*)data;
+        }
+    }
+    if (atomic_load_explicit(&self->injected_n, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&self->lock);
+        if (queue_pop_n(self->injected, &data, 1) == 1) {
+            atomic_fetch_sub_explicit(&self->injected_n, 1, memory_order_relaxed);
+        } else {
+            data = NULL;
+        }
+        pthread_mutex_unlock(&self->lock);
+    }
+    return (SchedulerTask*)data;
+}
+
+// Function to tell whether any deque or the submission queue holds a task
+static BOOL scheduler_has_work(Scheduler* self) {
+    if (atomic_load_explicit(&self->injected_n, memory_order_relaxed) > 0) {
+        return TRUE;
+    }
+    for (size_t i = 0; i < self->thread_n; i++) {
+        if (work_deque_length(self->workers[i].deque) > 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// Function to wake one sleeping worker when there is one.
+// The fence pairs with the one a worker takes before its last look for work: either that
+// worker sees the task just pushed, or this thread sees it registered as a sleeper.
+static inline void scheduler_wake(Scheduler* self) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&self->sleepers, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&self->lock);
+        pthread_cond_signal(&self->work);
+        pthread_mutex_unlock(&self->lock);
+    }
+}
+
+// Function to run tasks on a worker thread until the pool stops
+static void* scheduler_worker_run(void* arg) {
+    SchedulerWorker* worker = (SchedulerWorker*)arg;
+    Scheduler* self = worker->scheduler;
+    unsigned idle = 0;
+
+    scheduler_current = worker;
+    while (!atomic_load_explicit(&self->stop, memory_order_acquire)) {
+        SchedulerTask* task = scheduler_find(worker);
+        if (task != NULL) {
+            scheduler_execute(self, task);
+            idle = 0;
+            continue;
+        }
+        if (++idle < SCHEDULER_SPINS) {
+            continue;
+        }
+        if (idle < SCHEDULER_SPINS + SCHEDULER_YIELDS) {
+            sched_yield();
+            continue;
+        }
+
+        pthread_mutex_lock(&self->lock);
+        atomic_fetch_add_explicit(&self->sleepers, 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        // Look again once registered, a task pushed before now did not see this worker sleeping
+        if (!scheduler_has_work(self) && !atomic_load_explicit(&self->stop, memory_order_relaxed)) {
+            pthread_cond_wait(&self->work, &self->lock);
+        }
+        atomic_fetch_sub_explicit(&self->sleepers, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&self->lock);
+        idle = 0;
+    }
+    scheduler_current = NULL;
+    return NULL;
+}
+
+// Function to stop the workers already started and release everything the pool holds
+static void scheduler_shutdown(Scheduler* self, size_t started) {
+    pthread_mutex_lock(&self->lock);
+    atomic_store_explicit(&self->stop, 1, memory_order_release);
+    pthread_cond_broadcast(&self->work);
+    pthread_mutex_unlock(&self->lock);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(self->workers[i].thread, NULL);
+    }
+
+    for (size_t i = 0; i < self->thread_n; i++) {
+        work_deque_destroy(self->workers[i].deque);
+    }
+    queue_destroy(self->injected);
+    pthread_cond_destroy(&self->done);
+    pthread_cond_destroy(&self->work);
+    pthread_mutex_destroy(&self->lock);
+    STL_FREE(self->workers);
+    STL_FREE(self);
+}
+
+// Function to create a pool of thread_n workers (0 picks the number of online CPUs)
+Scheduler* scheduler_create(size_t thread_n) {
+    if (thread_n == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_n = cpus > 0 ? (size_t)cpus : 1;
+    }
+
+    Scheduler* self = (Scheduler*)STL_MALLOC(sizeof(Scheduler));
+    if (self == NULL) {
+        return NULL;
+    }
+    if ((self->workers = (SchedulerWorker*)STL_MALLOC(thread_n * sizeof(SchedulerWorker))) == NULL) {
+        STL_FREE(self);
+        return NULL;
+    }
+
+    // Unwind whatever was initialized when a later primitive fails
+    int ret = pthread_mutex_init(&self->lock, NULL);
+    if (ret == 0 && (ret = pthread_cond_init(&self->work, NULL)) != 0) {
+        pthread_mutex_destroy(&self->lock);
+    }
+    if (ret == 0 && (ret = pthread_cond_init(&self->done, NULL)) != 0) {
+        pthread_cond_destroy(&self->work);
+        pthread_mutex_destroy(&self->lock);
+    }
+    if (ret != 0) {
+        STL_FREE(self->workers);
+        STL_FREE(self);
+        return NULL;
+    }
+    self->thread_n = thread_n;
+    self->injected = queue_create(NULL, NULL);
+    atomic_init(&self->injected_n, 0);
+    atomic_init(&self->sleepers, 0);
+    atomic_init(&self->stop, 0);
+
+    // Every deque exists before any worker starts, since workers steal from each other right away
+    BOOL failed = self->injected == NULL;
+    for (size_t i = 0; i < thread_n; i++) {
+        SchedulerWorker* worker = &self->workers[i];
+        worker->scheduler = self;
+        worker->index = i;
+        worker->seed = (unsigned int)(i * 2654435761u + 1);
+        worker->deque = work_deque_create(SCHEDULER_DEQUE_SIZE, NULL, NULL);
+        failed = failed || worker->deque == NULL;
+    }
+    if (failed) {
+        scheduler_shutdown(self, 0);
+        return NULL;
+    }
+    for (size_t i = 0; i < thread_n; i++) {
+        if (pthread_create(&self->workers[i].thread, NULL, scheduler_worker_run, &self->workers[i]) != 0) {
+            scheduler_shutdown(self, i);
+            return NULL;
+        }
+    }
+    return self;
+}
+
+// Function to run func(ctx) on the pool and wait for it, with the tasks it spawns, to finish.
+// Called from inside a task, it runs func directly.
+int scheduler_run(Scheduler* self, SchedulerTaskFunc func, void* ctx) {
+    return_val_if_fail(self != NULL && func != NULL, ERR_NIL);
+    if (scheduler_current != NULL) {
+        func(ctx);
+        return OK;
+    }
+
+    SchedulerTask task;
+    task.func = func;
+    task.ctx = ctx;
+    task.root = TRUE;
+    atomic_init(&task.done, 0);
+
+    pthread_mutex_lock(&self->lock);
+    if (queue_push(self->injected, &task) != OK) {
+        pthread_mutex_unlock(&self->lock);
+        return ERR_OOM;
+    }
+    // Workers register as sleepers under this lock, so one that is not waiting yet will see injected_n
+    atomic_fetch_add_explicit(&self->injected_n, 1, memory_order_relaxed);
+    pthread_cond_signal(&self->work);
+    while (!atomic_load_explicit(&task.done, memory_order_acquire)) {
+        pthread_cond_wait(&self->done, &self->lock);
+    }
+    pthread_mutex_unlock(&self->lock);
+    return OK;
+}
+
+// Function to spawn func(ctx) as a child of the current task; it may run on any worker.
+// Called outside a worker thread, it runs func directly.
+int scheduler_spawn(SchedulerTask* task, SchedulerTaskFunc func, void* ctx) {
+    return_val_if_fail(task != NULL && func != NULL, ERR_NIL);
+    SchedulerWorker* worker = scheduler_current;
+
+    task->func = func;
+    task->ctx = ctx;
+    task->root = FALSE;
+    atomic_store_explicit(&task->done, 0, memory_order_relaxed);
+    // Without a deque to push to, running the child now is still a valid fork-join schedule
+    if (worker == NULL || work_deque_push(worker->deque, task) != OK) {
+        func(ctx);
+        atomic_store_explicit(&task->done, 1, memory_order_relaxed);
+        return OK;
+    }
+    scheduler_wake(worker->scheduler);
+    return OK;
+}
+
+// Function to wait for a spawned task, running pending tasks on this thread meanwhile
+int scheduler_join(SchedulerTask* task) {
+    return_val_if_fail(task != NULL, ERR_NIL);
+    SchedulerWorker* worker = scheduler_current;
+    unsigned idle = 0;
+
+    // The task is usually still at the bottom of this worker's deque and is popped and run here.
+    // When it was stolen, help with other tasks instead of blocking until the thief is done.
+    while (!atomic_load_explicit(&task->done, memory_order_acquire)) {
+        SchedulerTask* next = worker != NULL ? scheduler_find(worker) : NULL;
+        if (next != NULL) {
+            scheduler_execute(worker->scheduler, next);
+            idle = 0;
+        } else if (++idle >= SCHEDULER_SPINS) {
+            sched_yield();
+        }
+    }
+    return OK;
+}
+
+// Function to get the number of workers in the pool
+size_t scheduler_thread_n(Scheduler* self) {
+    return_val_if_fail(self != NULL, 0);
+    return self->thread_n;
+}
+
+// Function to destroy the pool, once no scheduler_run call is in progress
+void scheduler_destroy(Scheduler* self) {
+    if (self != NULL) {
+        scheduler_shutdown(self, self->thread_n);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "typedef.h"
+#include "queue.h"
+#include "work_deque.h"
+
+// Function pointer type for the body of a task
+typedef void (*SchedulerTaskFunc)(void* ctx);
+
+// Structure representing a spawned task. The spawning code owns it, usually as a local variable
+// of the parent task, and must keep it alive until scheduler_join returns.
+typedef struct {
+    SchedulerTaskFunc func;     // Task body
+    void* ctx;                  // Context passed to func
+    atomic_int done;            // Set once func has returned
+    BOOL root;                  // Submitted by scheduler_run from outside the pool
+} SchedulerTask;
+
+struct Scheduler;
+
+// Structure representing a worker thread and the deque its tasks are spawned into
+typedef struct {
+    struct Scheduler* scheduler;    // Pool the worker belongs to
+    WorkDeque* deque;               // Tasks spawned by this worker, stolen from by the others
+    pthread_t thread;               // Thread running the worker
+    size_t index;                   // Position in the pool
+    unsigned int seed;              // State for picking victims to steal from
+} SchedulerWorker;
+
+// Structure representing a fork-join thread pool with one work-stealing deque per worker.
+// A task spawns children onto its worker's deque and joins them; idle workers steal the oldest,
+// and so usually the largest, pending tasks from the others.
+typedef struct Scheduler {
+    SchedulerWorker* workers;       // Worker threads
+    size_t thread_n;                // Number of workers
+    Queue* injected;                // Root tasks submitted by scheduler_run, guarded by lock
+    atomic_size_t injected_n;       // Number of tasks in injected, read without the lock
+    atomic_size_t sleepers;         // Number of workers asleep or about to sleep on work
+    pthread_mutex_t lock;           // Guards injected and the condition variables
+    pthread_cond_t work;            // Signalled when tasks become available
+    pthread_cond_t done;            // Broadcast when a root task completes
+    atomic_int stop;                // Set when the pool shuts down
+} Scheduler;
+
+// Function to create a pool of thread_n workers (0 picks the number of online CPUs)
+Scheduler* scheduler_create(size_t thread_n);
+
+// Function to run func(ctx) on the pool and wait for it, with the tasks it spawns, to finish.
+// Called from inside a task, it runs func directly.
+int scheduler_run(Scheduler* self, SchedulerTaskFunc func, void* ctx);
+
+// Function to spawn func(ctx) as a child of the current task; it may run on any worker.
+// Called outside a worker thread, it runs func directly.
+int scheduler_spawn(SchedulerTask* task, SchedulerTaskFunc func, void* ctx);
+
+// Function to wait for a spawned task, running pending tasks on this thread meanwhile
+int scheduler_join(SchedulerTask* task);
+
+// Function to get the number of workers in the pool
+size_t scheduler_thread_n(Scheduler* self);
+
+// Function to destroy the pool, once no scheduler_run call is in progress
+void scheduler_destroy(Scheduler* self);
+
+#endif /*SCHEDULER_H*/
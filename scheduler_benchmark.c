@@ -0,0 +1,124 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "scheduler.h"
+
+// Below these sizes the fork-join tasks fall back to plain serial code
+#define FIB_CUTOFF 20
+#define SUM_GRAIN 4096
+
+// Structure representing one fib task: its argument, its result and whether to stop forking at FIB_CUTOFF
+typedef struct {
+    int n;
+    BOOL cutoff;
+    uint64_t result;
+} Fib;
+
+// Structure representing one sum task over data[low, high)
+typedef struct {
+    const uint64_t *data;
+    size_t low;
+    size_t high;
+    uint64_t result;
+} Sum;
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to compute fib(n) serially
+static uint64_t fib_serial(int n) {
+    return n < 2 ? (uint64_t)n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+// Function to compute fib(n), spawning fib(n - 1) and running fib(n - 2) on this thread
+static void fib_task(void *ctx) {
+    Fib *fib = (Fib*)ctx;
+    if (fib->n < 2 || (fib->cutoff && fib->n < FIB_CUTOFF)) {
+        fib->result = fib_serial(fib->n);
+        return;
+    }
+
+    Fib left = {fib->n - 1, fib->cutoff, 0};
+    Fib right = {fib->n - 2, fib->cutoff, 0};
+    SchedulerTask task;
+    scheduler_spawn(&task, fib_task, &left);
+    fib_task(&right);
+    scheduler_join(&task);
+    fib->result = left.result + right.result;
+}
+
+// Function to sum data[low, high), splitting the range in halves down to SUM_GRAIN elements
+static void sum_task(void *ctx) {
+    Sum *sum = (Sum*)ctx;
+    if (sum->high - sum->low <= SUM_GRAIN) {
+        uint64_t result = 0;
+        for (size_t i = sum->low; i < sum->high; i++) {
+            result += sum->data[i];
+        }
+        sum->result = result;
+        return;
+    }
+
+    size_t mid = sum->low + (sum->high - sum->low) / 2;
+    Sum left = {sum->data, sum->low, mid, 0};
+    Sum right = {sum->data, mid, sum->high, 0};
+    SchedulerTask task;
+    scheduler_spawn(&task, sum_task, &left);
+    sum_task(&right);
+    scheduler_join(&task);
+    sum->result = left.result + right.result;
+}
+
+int main(int argc, char *argv[]) {
+    int fib_n = argc > 1 ? atoi(argv[1]) : 32;
+    size_t sum_n = argc > 2 ? strtoul(argv[2], NULL, 10) : 64000000;
+    size_t max_threads = argc > 3 ? strtoul(argv[3], NULL, 10) : 8;
+    uint64_t *data = (uint64_t*)malloc(sum_n * sizeof(uint64_t));
+    for (size_t i = 0; i < sum_n; i++) {
+        data[i] = i;
+    }
+
+    double start = now_ns();
+    uint64_t expect_fib = fib_serial(fib_n);
+    double fib_ms = (now_ns() - start) / 1e6;
+    start = now_ns();
+    Sum serial_sum = {data, 0, sum_n, 0};
+    for (size_t i = 0; i < sum_n; i++) {
+        serial_sum.result += data[i];
+    }
+    double sum_ms = (now_ns() - start) / 1e6;
+
+    printf("fib(%d) without cutoff measures spawn/join overhead; with cutoff %d and sum of %zu elements measure scaling\n",
+           fib_n, FIB_CUTOFF, sum_n);
+    printf("%-8s %14s %14s %14s %8s\n", "threads", "fib(ms)", "fib cut(ms)", "sum(ms)", "check");
+    printf("%-8s %14.1f %14.1f %14.1f %8s\n", "serial", fib_ms, fib_ms, sum_ms, "-");
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        Scheduler *scheduler = scheduler_create(threads);
+        Fib fib = {fib_n, FALSE, 0};
+        Fib fib_cut = {fib_n, TRUE, 0};
+        Sum sum = {data, 0, sum_n, 0};
+
+        start = now_ns();
+        scheduler_run(scheduler, fib_task, &fib);
+        double fib_par_ms = (now_ns() - start) / 1e6;
+        start = now_ns();
+        scheduler_run(scheduler, fib_task, &fib_cut);
+        double fib_cut_ms = (now_ns() - start) / 1e6;
+        start = now_ns();
+        scheduler_run(scheduler, sum_task, &sum);
+        double sum_par_ms = (now_ns() - start) / 1e6;
+
+        BOOL ok = fib.result == expect_fib && fib_cut.result == expect_fib && sum.result == serial_sum.result;
+        printf("%-8zu %14.1f %14.1f %14.1f %8s\n", threads, fib_par_ms, fib_cut_ms, sum_par_ms, ok ? "ok" : "MISMATCH");
+        scheduler_destroy(scheduler);
+    }
+
+    free(data);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "array.h"
+#include "sort.h"
+
+// Comparison function for the sorted keys
+int data_cmp(void *i, void *j) {
+    uint64_t a = *(uint64_t*)i;
+    uint64_t b = *(uint64_t*)j;
+    return (a > b) - (a < b);
+}
+
+// Function to get a random 64-bit value
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = (*state += 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 16000000;
+    size_t m = argc > 2 ? strtoul(argv[2], NULL, 10) : 4000000;
+    uint64_t *values = (uint64_t*)malloc(max_n * sizeof(uint64_t));
+    uint64_t *queries = (uint64_t*)malloc(m * sizeof(uint64_t));
+    void **keys = (void**)malloc(m * sizeof(void*));
+    size_t *results = (size_t*)malloc(m * sizeof(size_t));
+    Array *array = array_create(NULL, NULL);
+    uint64_t state = 42;
+
+    printf("%zu lookups of random keys, ns per lookup\n", m);
+    printf("%-10s %14s %14s %14s %14s %7s\n", "n", "binary_search", "lower_bound", "batch", "batch sorted", "check");
+    for (size_t n = 1000; n <= max_n; n *= 16) {
+        // Even values only, so half of the lookups miss
+        for (size_t i = 0; i < n; i++) {
+            values[i] = 2 * i;
+        }
+        array_resize(array, n);
+        for (size_t i = 0; i < n; i++) {
+            array->data[i] = &values[i];
+        }
+        for (size_t i = 0; i < m; i++) {
+            queries[i] = next_random(&state) % (2 * n);
+            keys[i] = &queries[i];
+        }
+
+        size_t expect = 0;
+        double start = now_ns();
+        for (size_t i = 0; i < m; i++) {
+            expect += binary_search(array, 0, n - 1, keys[i], (SortGetFunc)array_get_by_index, (SortCmpFunc)data_cmp);
+        }
+        double search_ns = (now_ns() - start) / (double)m;
+
+        size_t sum = 0;
+        start = now_ns();
+        for (size_t i = 0; i < m; i++) {
+            sum += array_lower_bound(array, keys[i], data_cmp);
+        }
+        double lower_ns = (now_ns() - start) / (double)m;
+
+        start = now_ns();
+        array_lower_bound_batch(array, keys, m, data_cmp, results);
+        double batch_ns = (now_ns() - start) / (double)m;
+        size_t batch_sum = 0;
+        for (size_t i = 0; i < m; i++) {
+            batch_sum += results[i];
+        }
+
+        // Sorting the keys first lets the batch sweep the array once; the sort is not timed
+        Array keys_array = {.data = keys, .size = m, .alloc_size = m, .elem_size = 0};
+        array_sort(&keys_array, data_cmp, NULL);
+        start = now_ns();
+        array_lower_bound_batch_sorted(array, keys, m, data_cmp, results);
+        double sorted_ns = (now_ns() - start) / (double)m;
+        size_t sorted_sum = 0;
+        for (size_t i = 0; i < m; i++) {
+            sorted_sum += results[i];
+        }
+
+        // binary_search lands on the insertion point for misses and on the match for hits, as lower_bound does
+        // with distinct values
+        BOOL ok = sum == expect && batch_sum == expect && sorted_sum == expect;
+        printf("%-10zu %14.1f %14.1f %14.1f %14.1f %7s\n", n, search_ns, lower_ns, batch_ns, sorted_ns,
+               ok ? "ok" : "MISMATCH");
+    }
+
+    array_destroy(array);
+    free(results);
+    free(keys);
+    free(queries);
+    free(values);
+    return 0;
+}
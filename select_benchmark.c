@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "array.h"
+
+// Number of comparator calls made through data_cmp
+static size_t cmp_calls = 0;
+
+// Comparison function ordering scores from highest to lowest, so the first k elements are the top k
+int data_cmp(void *i, void *j) {
+    uint64_t a = *(uint64_t*)i;
+    uint64_t b = *(uint64_t*)j;
+    cmp_calls++;
+    return (a < b) - (a > b);
+}
+
+// Function to get a random 64-bit value
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = (*state += 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Function to point the array at the scores in their original order
+static void reset(Array *array, uint64_t *scores, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        array->data[i] = &scores[i];
+    }
+}
+
+// Function to get the current monotonic time in milliseconds
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000000;
+    uint64_t *scores = (uint64_t*)malloc(n * sizeof(uint64_t));
+    Array *array = array_create(NULL, NULL);
+    Array *top = array_create(NULL, NULL);
+    uint64_t state = 42;
+
+    array_resize(array, n);
+    for (size_t i = 0; i < n; i++) {
+        scores[i] = next_random(&state);
+    }
+
+    // The full sort is the reference every selection is checked against
+    reset(array, scores, n);
+    cmp_calls = 0;
+    double start = now_ms();
+    array_sort(array, data_cmp, NULL);
+    double sort_ms = now_ms() - start;
+    double sort_cmps = (double)cmp_calls / (double)n;
+    uint64_t *sorted = (uint64_t*)malloc(n * sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) {
+        sorted[i] = *(uint64_t*)array->data[i];
+    }
+
+    printf("%zu elements, ms and comparisons per element to get the top k\n", n);
+    printf("%-9s %16s %16s %16s %16s %8s\n", "k", "array_sort", "nth_element", "partial_sort", "top_k", "check");
+    size_t ks[] = {10, 100, 10000, 100000, 1000000};
+    for (size_t i = 0; i < sizeof(ks) / sizeof(ks[0]) && ks[i] <= n; i++) {
+        size_t k = ks[i];
+        double ms[3];
+        double cmps[3];
+        BOOL ok = TRUE;
+
+        for (int algo = 0; algo < 3; algo++) {
+            reset(array, scores, n);
+            cmp_calls = 0;
+            start = now_ms();
+            if (algo == 0) {
+                array_nth_element(array, k - 1, data_cmp);
+            } else if (algo == 1) {
+                array_partial_sort(array, k, data_cmp);
+            } else {
+                array_top_k(array, k, data_cmp, top);
+            }
+            ms[algo] = now_ms() - start;
+            cmps[algo] = (double)cmp_calls / (double)n;
+
+            if (algo == 0) {
+                ok = ok && *(uint64_t*)array->data[k - 1] == sorted[k - 1];
+            } else {
+                Array *result = algo == 1 ? array : top;
+                for (size_t j = 0; j < k; j++) {
+                    ok = ok && *(uint64_t*)result->data[j] == sorted[j];
+                }
+            }
+        }
+        printf("%-9zu %9.1f %6.1f %9.1f %6.1f %9.1f %6.1f %9.1f %6.1f %8s\n", k, sort_ms, sort_cmps,
+               ms[0], cmps[0], ms[1], cmps[1], ms[2], cmps[2], ok ? "ok" : "MISMATCH");
+    }
+
+    free(sorted);
+    free(scores);
+    array_destroy(top);
+    array_destroy(array);
+    return 0;
+}
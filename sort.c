@@ -1,62 +1,1852 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "sort.h"
+#include "typed_sort.h"
 #include "typedef.h"
 
-// Function to partition the array for quicksort
-static size_t partition(void *arr, size_t low, size_t high, SortGetFunc get, SortSetFunc set, SortCmpFunc cmp, SortSwapFunc swap) {
-    void *pivot = NULL;
-    get(arr, high, &pivot);
+// The typed sorts use AVX2 kernels, compiled for AVX2 whatever the target and picked at run time, on x86
+// with GCC or Clang
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SORT_SIMD_AVX2
+#define SORT_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+
+// Partitions at or below this size are finished with insertion sort
+#define SORT_INSERTION_THRESHOLD 16
+
+// Partitions above this size pick the pivot with Tukey's ninther
+#define SORT_NINTHER_THRESHOLD 128
+
+// Pending partitions are pushed larger-first, so the stack never exceeds log2(SIZE_MAX) entries
+#define SORT_STACK_SIZE 64
+
+// Structure bundling the callbacks used by the sorting routines
+typedef struct {
+    void *arr;
+    SortGetFunc get;
+    SortCmpFunc cmp;
+    SortSwapFunc swap;
+} SortCtx;
+
+// Structure representing a pending partition of the introsort
+typedef struct {
+    size_t low;
+    size_t high;
+    size_t depth;
+} SortRange;
+
+// Function to get the element at a specific index
+static inline void *sort_at(SortCtx *ctx, size_t index) {
+    void *data = NULL;
+    ctx->get(ctx->arr, index, &data);
+    return data;
+}
+
+// Function to check whether the element at index i orders before the element at index j
+static inline BOOL sort_less(SortCtx *ctx, size_t i, size_t j) {
+    return ctx->cmp(sort_at(ctx, i), sort_at(ctx, j)) < 0;
+}
+
+// Function to order the elements at a, b and c so that the median ends up at b
+static void sort_median3(SortCtx *ctx, size_t a, size_t b, size_t c) {
+    if (sort_less(ctx, b, a)) {
+        ctx->swap(ctx->arr, a, b);
+    }
+    if (sort_less(ctx, c, b)) {
+        ctx->swap(ctx->arr, b, c);
+        if (sort_less(ctx, b, a)) {
+            ctx->swap(ctx->arr, a, b);
+        }
+    }
+}
+
+// Function to sort a small range with insertion sort
+static void sort_insertion(SortCtx *ctx, size_t low, size_t high) {
+    for (size_t i = low + 1; i <= high; i++) {
+        for (size_t j = i; j > low && sort_less(ctx, j, j - 1); j--) {
+            ctx->swap(ctx->arr, j, j - 1);
+        }
+    }
+}
+
+// Function to restore the max-heap property below a node of a heap rooted at low
+static void sort_sift_down(SortCtx *ctx, size_t low, size_t root, size_t n) {
+    size_t child;
+    while ((child = 2 * root + 1) < n) {
+        if (child + 1 < n && sort_less(ctx, low + child, low + child + 1)) {
+            child++;
+        }
+        if (!sort_less(ctx, low + root, low + child)) {
+            break;
+        }
+        ctx->swap(ctx->arr, low + root, low + child);
+        root = child;
+    }
+}
+
+// Function to sort a range with heapsort, used when the introsort recursion gets too deep
+static void sort_heap(SortCtx *ctx, size_t low, size_t high) {
+    size_t n = high - low + 1;
+    for (size_t i = n / 2; i > 0; i--) {
+        sort_sift_down(ctx, low, i - 1, n);
+    }
+    while (n > 1) {
+        n--;
+        ctx->swap(ctx->arr, low, low + n);
+        sort_sift_down(ctx, low, 0, n);
+    }
+}
+
+// Function to move a median-of-three (or ninther) pivot to the low end of the range
+static void sort_choose_pivot(SortCtx *ctx, size_t low, size_t high) {
+    size_t n = high - low + 1;
+    size_t mid = low + n / 2;
+
+    if (n > SORT_NINTHER_THRESHOLD) {
+        size_t step = n / 8;
+        sort_median3(ctx, low, low + step, low + 2 * step);
+        sort_median3(ctx, mid - step, mid, mid + step);
+        sort_median3(ctx, high - 2 * step, high - step, high);
+        sort_median3(ctx, low + step, mid, high - step);
+    } else {
+        sort_median3(ctx, low, mid, high);
+    }
+    ctx->swap(ctx->arr, low, mid);
+}
+
+// Function to partition the range around the pivot at low, returning the pivot's final index
+static size_t partition(SortCtx *ctx, size_t low, size_t high) {
+    // The pivot slot is not touched until the end, so the pointer stays valid
+    // even when get returns the address of the element rather than a copy
+    void *pivot = sort_at(ctx, low);
     size_t i = low;
+    size_t j = high + 1;
 
-    for (size_t j = low; j < high; j++) {
-        void *current = NULL;
-        get(arr, j, &current);
-        if (cmp(current, pivot) < 0) {
-            if (i != j) {
-                swap(arr, i, j);
-            }
+    // Hoare scheme: both scans stop on elements equal to the pivot, which keeps
+    // the partitions balanced on inputs with many duplicates
+    while (1) {
+        do {
             i++;
+        } while (i <= high && ctx->cmp(sort_at(ctx, i), pivot) < 0);
+
+        do {
+            j--;
+        } while (ctx->cmp(pivot, sort_at(ctx, j)) < 0);
+
+        if (i >= j) {
+            break;
         }
+        ctx->swap(ctx->arr, i, j);
     }
 
-    if (i != high) {
-        swap(arr, i, high);
+    if (j != low) {
+        ctx->swap(ctx->arr, low, j);
     }
-    return i;
+    return j;
 }
 
-// Function to perform quicksort on an array
+// Function to perform quicksort (introsort) on an array
 void quick_sort(void *arr, size_t low, size_t high, SortGetFunc get, SortSetFunc set, SortCmpFunc cmp, SortSwapFunc swap) {
-    // Allocate memory for the stack used in the iterative implementation of quicksort
-    size_t* stack = (size_t*)STL_MALLOC((high - low + 1) * sizeof(size_t));
-    int top = -1;
+    SortCtx ctx = {arr, get, cmp, swap};
+    SortRange stack[SORT_STACK_SIZE];
+    size_t top = 0;
+    size_t depth = 0;
+
+    (void)set;
+    if (get == NULL || cmp == NULL || swap == NULL || low >= high) {
+        return;
+    }
+
+    // Allow 2 * log2(n) levels of partitioning before falling back to heapsort
+    for (size_t n = high - low + 1; n > 1; n >>= 1) {
+        depth += 2;
+    }
+
+    stack[top++] = (SortRange){low, high, depth};
+    while (top > 0) {
+        SortRange range = stack[--top];
+        low = range.low;
+        high = range.high;
+        depth = range.depth;
+
+        while (high - low + 1 > SORT_INSERTION_THRESHOLD) {
+            if (depth == 0) {
+                sort_heap(&ctx, low, high);
+                break;
+            }
+            depth--;
+
+            sort_choose_pivot(&ctx, low, high);
+            size_t mid = partition(&ctx, low, high);
+
+            // Defer the larger side and keep working on the smaller one
+            if (mid - low > high - mid) {
+                if (mid > low + 1) {
+                    stack[top++] = (SortRange){low, mid - 1, depth};
+                }
+                low = mid + 1;
+            } else {
+                if (mid + 1 < high) {
+                    stack[top++] = (SortRange){mid + 1, high, depth};
+                }
+                if (mid == low) {
+                    low = high;
+                } else {
+                    high = mid - 1;
+                }
+            }
+
+            if (low >= high) {
+                break;
+            }
+        }
+
+        if (low < high && high - low + 1 <= SORT_INSERTION_THRESHOLD) {
+            sort_insertion(&ctx, low, high);
+        }
+    }
+}
+
+// Function to order the pointers at a, b and c so that the median ends up at b
+static inline void sort_ptr_median3(void **data, size_t a, size_t b, size_t c, SortCmpFunc cmp) {
+    void *tmp;
+    if (cmp(data[b], data[a]) < 0) {
+        tmp = data[a]; data[a] = data[b]; data[b] = tmp;
+    }
+    if (cmp(data[c], data[b]) < 0) {
+        tmp = data[b]; data[b] = data[c]; data[c] = tmp;
+        if (cmp(data[b], data[a]) < 0) {
+            tmp = data[a]; data[a] = data[b]; data[b] = tmp;
+        }
+    }
+}
+
+// Function to sort a small range of pointers with insertion sort
+static void sort_ptr_insertion(void **data, size_t low, size_t high, SortCmpFunc cmp) {
+    for (size_t i = low + 1; i <= high; i++) {
+        void *current = data[i];
+        size_t j = i;
+        while (j > low && cmp(current, data[j - 1]) < 0) {
+            data[j] = data[j - 1];
+            j--;
+        }
+        data[j] = current;
+    }
+}
+
+// Function to restore the max-heap property below a node of a pointer heap
+static void sort_ptr_sift_down(void **data, size_t root, size_t n, SortCmpFunc cmp) {
+    void *current = data[root];
+    size_t child;
+    while ((child = 2 * root + 1) < n) {
+        if (child + 1 < n && cmp(data[child], data[child + 1]) < 0) {
+            child++;
+        }
+        if (cmp(current, data[child]) >= 0) {
+            break;
+        }
+        data[root] = data[child];
+        root = child;
+    }
+    data[root] = current;
+}
+
+// Function to sort a max-heap of pointers by repeatedly moving its root behind the shrinking heap
+static void sort_ptr_heap_sorted(void **data, size_t n, SortCmpFunc cmp) {
+    while (n > 1) {
+        n--;
+        void *tmp = data[0];
+        data[0] = data[n];
+        data[n] = tmp;
+        sort_ptr_sift_down(data, 0, n, cmp);
+    }
+}
+
+// Function to sort a range of pointers with heapsort
+static void sort_ptr_heap(void **data, size_t n, SortCmpFunc cmp) {
+    for (size_t i = n / 2; i > 0; i--) {
+        sort_ptr_sift_down(data, i - 1, n, cmp);
+    }
+    sort_ptr_heap_sorted(data, n, cmp);
+}
+
+// Function to partition a range of pointers around a median-of-three (or ninther) pivot
+static size_t sort_ptr_partition(void **data, size_t low, size_t high, SortCmpFunc cmp) {
+    size_t n = high - low + 1;
+    size_t mid = low + n / 2;
+    void *tmp;
+
+    if (n > SORT_NINTHER_THRESHOLD) {
+        size_t step = n / 8;
+        sort_ptr_median3(data, low, low + step, low + 2 * step, cmp);
+        sort_ptr_median3(data, mid - step, mid, mid + step, cmp);
+        sort_ptr_median3(data, high - 2 * step, high - step, high, cmp);
+        sort_ptr_median3(data, low + step, mid, high - step, cmp);
+    } else {
+        sort_ptr_median3(data, low, mid, high, cmp);
+    }
+
+    void *pivot = data[mid];
+    data[mid] = data[low];
+    data[low] = pivot;
+
+    size_t i = low;
+    size_t j = high + 1;
+    while (1) {
+        do {
+            i++;
+        } while (i <= high && cmp(data[i], pivot) < 0);
+
+        do {
+            j--;
+        } while (cmp(pivot, data[j]) < 0);
+
+        if (i >= j) {
+            break;
+        }
+        tmp = data[i];
+        data[i] = data[j];
+        data[j] = tmp;
+    }
+
+    data[low] = data[j];
+    data[j] = pivot;
+    return j;
+}
+
+// Function to sort an array of pointers in place (introsort)
+void quick_sort_ptr(void **data, size_t n, SortCmpFunc cmp) {
+    SortRange stack[SORT_STACK_SIZE];
+    size_t top = 0;
+    size_t depth = 0;
+
+    if (data == NULL || cmp == NULL || n < 2) {
+        return;
+    }
+
+    for (size_t m = n; m > 1; m >>= 1) {
+        depth += 2;
+    }
+
+    stack[top++] = (SortRange){0, n - 1, depth};
+    while (top > 0) {
+        SortRange range = stack[--top];
+        size_t low = range.low;
+        size_t high = range.high;
+        depth = range.depth;
+
+        while (high - low + 1 > SORT_INSERTION_THRESHOLD) {
+            if (depth == 0) {
+                sort_ptr_heap(data + low, high - low + 1, cmp);
+                break;
+            }
+            depth--;
+
+            size_t mid = sort_ptr_partition(data, low, high, cmp);
+
+            // Defer the larger side and keep working on the smaller one
+            if (mid - low > high - mid) {
+                if (mid > low + 1) {
+                    stack[top++] = (SortRange){low, mid - 1, depth};
+                }
+                low = mid + 1;
+            } else {
+                if (mid + 1 < high) {
+                    stack[top++] = (SortRange){mid + 1, high, depth};
+                }
+                if (mid == low) {
+                    low = high;
+                } else {
+                    high = mid - 1;
+                }
+            }
+
+            if (low >= high) {
+                break;
+            }
+        }
+
+        if (low < high && high - low + 1 <= SORT_INSERTION_THRESHOLD) {
+            sort_ptr_insertion(data, low, high, cmp);
+        }
+    }
+}
+
+// Function to get the address of element i of size bytes in a contiguous array
+static inline char *sort_elem(void *data, size_t i, size_t size) {
+    return (char *)data + i * size;
+}
 
-    stack[++top] = low;
-    stack[++top] = high;
+// Function to swap two elements of size bytes, a word at a time
+static inline void sort_elem_swap(char *a, char *b, size_t size) {
+    uint64_t x, y;
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), a += sizeof(uint64_t), b += sizeof(uint64_t)) {
+        memcpy(&x, a, sizeof(x));
+        memcpy(&y, b, sizeof(y));
+        memcpy(a, &y, sizeof(y));
+        memcpy(b, &x, sizeof(x));
+    }
+    if (size >= sizeof(uint32_t)) {
+        uint32_t u, v;
+        memcpy(&u, a, sizeof(u));
+        memcpy(&v, b, sizeof(v));
+        memcpy(a, &v, sizeof(v));
+        memcpy(b, &u, sizeof(u));
+        size -= sizeof(uint32_t);
+        a += sizeof(uint32_t);
+        b += sizeof(uint32_t);
+    }
+    for (; size > 0; size--, a++, b++) {
+        char tmp = *a;
+        *a = *b;
+        *b = tmp;
+    }
+}
 
-    while (top >= 0) {
-        high = stack[top--];
-        low = stack[top--];
+// Function to order the elements at a, b and c so that the median ends up at b
+static inline void sort_elem_median3(void *data, size_t a, size_t b, size_t c, size_t size, SortCmpFunc cmp) {
+    if (cmp(sort_elem(data, b, size), sort_elem(data, a, size)) < 0) {
+        sort_elem_swap(sort_elem(data, a, size), sort_elem(data, b, size), size);
+    }
+    if (cmp(sort_elem(data, c, size), sort_elem(data, b, size)) < 0) {
+        sort_elem_swap(sort_elem(data, b, size), sort_elem(data, c, size), size);
+        if (cmp(sort_elem(data, b, size), sort_elem(data, a, size)) < 0) {
+            sort_elem_swap(sort_elem(data, a, size), sort_elem(data, b, size), size);
+        }
+    }
+}
 
-        size_t mid = partition(arr, low, high, get, set, cmp, swap);
-        if (mid > low) {
-            stack[++top] = low;
-            stack[++top] = mid - 1;
+// Function to sort a small range of elements with insertion sort, moving each one down by swaps
+static void sort_elem_insertion(void *data, size_t low, size_t high, size_t size, SortCmpFunc cmp) {
+    for (size_t i = low + 1; i <= high; i++) {
+        for (size_t j = i; j > low && cmp(sort_elem(data, j, size), sort_elem(data, j - 1, size)) < 0; j--) {
+            sort_elem_swap(sort_elem(data, j, size), sort_elem(data, j - 1, size), size);
         }
+    }
+}
 
-        if (mid < high) {
-            stack[++top] = mid + 1;
-            stack[++top] = high;
+// Function to restore the max-heap property below a node of a heap of elements
+static void sort_elem_sift_down(void *data, size_t root, size_t n, size_t size, SortCmpFunc cmp) {
+    size_t child;
+    while ((child = 2 * root + 1) < n) {
+        if (child + 1 < n && cmp(sort_elem(data, child, size), sort_elem(data, child + 1, size)) < 0) {
+            child++;
+        }
+        if (cmp(sort_elem(data, root, size), sort_elem(data, child, size)) >= 0) {
+            break;
         }
+        sort_elem_swap(sort_elem(data, root, size), sort_elem(data, child, size), size);
+        root = child;
+    }
+}
+
+// Function to sort a range of elements with heapsort
+static void sort_elem_heap(void *data, size_t n, size_t size, SortCmpFunc cmp) {
+    for (size_t i = n / 2; i > 0; i--) {
+        sort_elem_sift_down(data, i - 1, n, size, cmp);
+    }
+    while (n > 1) {
+        n--;
+        sort_elem_swap(sort_elem(data, 0, size), sort_elem(data, n, size), size);
+        sort_elem_sift_down(data, 0, n, size, cmp);
+    }
+}
+
+// Function to partition a range of elements around a median-of-three (or ninther) pivot. The pivot stays at low
+// while the range is partitioned, so it is compared in place rather than copied out.
+static size_t sort_elem_partition(void *data, size_t low, size_t high, size_t size, SortCmpFunc cmp) {
+    size_t n = high - low + 1;
+    size_t mid = low + n / 2;
+
+    if (n > SORT_NINTHER_THRESHOLD) {
+        size_t step = n / 8;
+        sort_elem_median3(data, low, low + step, low + 2 * step, size, cmp);
+        sort_elem_median3(data, mid - step, mid, mid + step, size, cmp);
+        sort_elem_median3(data, high - 2 * step, high - step, high, size, cmp);
+        sort_elem_median3(data, low + step, mid, high - step, size, cmp);
+    } else {
+        sort_elem_median3(data, low, mid, high, size, cmp);
+    }
+
+    char *pivot = sort_elem(data, low, size);
+    sort_elem_swap(pivot, sort_elem(data, mid, size), size);
+
+    size_t i = low;
+    size_t j = high + 1;
+    while (1) {
+        do {
+            i++;
+        } while (i <= high && cmp(sort_elem(data, i, size), pivot) < 0);
+
+        do {
+            j--;
+        } while (cmp(pivot, sort_elem(data, j, size)) < 0);
+
+        if (i >= j) {
+            break;
+        }
+        sort_elem_swap(sort_elem(data, i, size), sort_elem(data, j, size), size);
+    }
+
+    sort_elem_swap(pivot, sort_elem(data, j, size), size);
+    return j;
+}
+
+// Function to sort contiguous elements of size bytes in place (introsort)
+void quick_sort_inline(void *data, size_t n, size_t size, SortCmpFunc cmp) {
+    SortRange stack[SORT_STACK_SIZE];
+    size_t top = 0;
+    size_t depth = 0;
+
+    if (data == NULL || cmp == NULL || size == 0 || n < 2) {
+        return;
+    }
+
+    for (size_t m = n; m > 1; m >>= 1) {
+        depth += 2;
+    }
+
+    stack[top++] = (SortRange){0, n - 1, depth};
+    while (top > 0) {
+        SortRange range = stack[--top];
+        size_t low = range.low;
+        size_t high = range.high;
+        depth = range.depth;
+
+        while (high - low + 1 > SORT_INSERTION_THRESHOLD) {
+            if (depth == 0) {
+                sort_elem_heap(sort_elem(data, low, size), high - low + 1, size, cmp);
+                break;
+            }
+            depth--;
+
+            size_t mid = sort_elem_partition(data, low, high, size, cmp);
+
+            // Defer the larger side and keep working on the smaller one
+            if (mid - low > high - mid) {
+                if (mid > low + 1) {
+                    stack[top++] = (SortRange){low, mid - 1, depth};
+                }
+                low = mid + 1;
+            } else {
+                if (mid + 1 < high) {
+                    stack[top++] = (SortRange){mid + 1, high, depth};
+                }
+                if (mid == low) {
+                    low = high;
+                } else {
+                    high = mid - 1;
+                }
+            }
+
+            if (low >= high) {
+                break;
+            }
+        }
+
+        if (low < high && high - low + 1 <= SORT_INSERTION_THRESHOLD) {
+            sort_elem_insertion(data, low, high, size, cmp);
+        }
+    }
+}
+
+// Scalar instances of typed_sort.h's introsort, the fallback of the typed sorts below on CPUs without AVX2
+CSTL_SORT_DECLARE(sort_scalar_i32, int32_t, CSTL_LESS)
+CSTL_SORT_DECLARE(sort_scalar_i64, int64_t, CSTL_LESS)
+CSTL_SORT_DECLARE(sort_scalar_u64, uint64_t, CSTL_LESS)
+
+// Function to map float keys in place to int32 keys with the same order, or back, since the mapping is its own
+// inverse: negative floats have every bit but the sign flipped so that larger magnitudes compare lower
+static void sort_float_keys(float *data, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int32_t bits;
+        memcpy(&bits, &data[i], sizeof(bits));
+        bits ^= (int32_t)((uint32_t)(bits >> 31) >> 1);
+        memcpy(&data[i], &bits, sizeof(bits));
+    }
+}
+
+// Function to sort int32 keys in place with the scalar introsort
+void sort_int32_scalar(int32_t *data, size_t n) {
+    sort_scalar_i32_sort(data, n);
+}
+
+// Function to sort uint64 keys in place with the scalar introsort
+void sort_uint64_scalar(uint64_t *data, size_t n) {
+    sort_scalar_u64_sort(data, n);
+}
+
+// Function to sort float keys in place with the scalar introsort
+void sort_float_scalar(float *data, size_t n) {
+    if (data == NULL) {
+        return;
+    }
+    sort_float_keys(data, n);
+    sort_scalar_i32_sort((int32_t *)data, n);
+    sort_float_keys(data, n);
+}
+
+#ifdef SORT_SIMD_AVX2
+
+// Ranges of at most this many keys are sorted by a bitonic network over SORT_AVX2_BLOCK_VECTORS registers
+#define SORT_AVX2_BLOCK_VECTORS 16
+#define SORT_AVX2_I32_BLOCK (SORT_AVX2_BLOCK_VECTORS * 8)
+#define SORT_AVX2_I64_BLOCK (SORT_AVX2_BLOCK_VECTORS * 4)
+
+// Partition permutations indexed by the mask of lanes greater than the pivot: the lanes that are not come
+// first and those that are come last, each group in lane order. Entries pack one 32-bit lane index per nibble.
+static const uint32_t sort_avx2_i32_perm[256] = {
+    0x76543210, 0x07654321, 0x17654320, 0x10765432, 0x27654310, 0x20765431, 0x21765430, 0x21076543,
+    0x37654210, 0x30765421, 0x31765420, 0x31076542, 0x32765410, 0x32076541, 0x32176540, 0x32107654,
+    0x47653210, 0x40765321, 0x41765320, 0x41076532, 0x42765310, 0x42076531, 0x42176530, 0x42107653,
+    0x43765210, 0x43076521, 0x43176520, 0x43107652, 0x43276510, 0x43207651, 0x43217650, 0x43210765,
+    0x57643210, 0x50764321, 0x51764320, 0x51076432, 0x52764310, 0x52076431, 0x52176430, 0x52107643,
+    0x53764210, 0x53076421, 0x53176420, 0x53107642, 0x53276410, 0x53207641, 0x53217640, 0x53210764,
+    0x54763210, 0x54076321, 0x54176320, 0x54107632, 0x54276310, 0x54207631, 0x54217630, 0x54210763,
+    0x54376210, 0x54307621, 0x54317620, 0x54310762, 0x54327610, 0x54320761, 0x54321760, 0x54321076,
+    0x67543210, 0x60754321, 0x61754320, 0x61075432, 0x62754310, 0x62075431, 0x62175430, 0x62107543,
+    0x63754210, 0x63075421, 0x63175420, 0x63107542, 0x63275410, 0x63207541, 0x63217540, 0x63210754,
+    0x64753210, 0x64075321, 0x64175320, 0x64107532, 0x64275310, 0x64207531, 0x64217530, 0x64210753,
+    0x64375210, 0x64307521, 0x64317520, 0x64310752, 0x64327510, 0x64320751, 0x64321750, 0x64321075,
+    0x65743210, 0x65074321, 0x65174320, 0x65107432, 0x65274310, 0x65207431, 0x65217430, 0x65210743,
+    0x65374210, 0x65307421, 0x65317420, 0x65310742, 0x65327410, 0x65320741, 0x65321740, 0x65321074,
+    0x65473210, 0x65407321, 0x65417320, 0x65410732, 0x65427310, 0x65420731, 0x65421730, 0x65421073,
+    0x65437210, 0x65430721, 0x65431720, 0x65431072, 0x65432710, 0x65432071, 0x65432170, 0x65432107,
+    0x76543210, 0x70654321, 0x71654320, 0x71065432, 0x72654310, 0x72065431, 0x72165430, 0x72106543,
+    0x73654210, 0x73065421, 0x73165420, 0x73106542, 0x73265410, 0x73206541, 0x73216540, 0x73210654,
+    0x74653210, 0x74065321, 0x74165320, 0x74106532, 0x74265310, 0x74206531, 0x74216530, 0x74210653,
+    0x74365210, 0x74306521, 0x74316520, 0x74310652, 0x74326510, 0x74320651, 0x74321650, 0x74321065,
+    0x75643210, 0x75064321, 0x75164320, 0x75106432, 0x75264310, 0x75206431, 0x75216430, 0x75210643,
+    0x75364210, 0x75306421, 0x75316420, 0x75310642, 0x75326410, 0x75320641, 0x75321640, 0x75321064,
+    0x75463210, 0x75406321, 0x75416320, 0x75410632, 0x75426310, 0x75420631, 0x75421630, 0x75421063,
+    0x75436210, 0x75430621, 0x75431620, 0x75431062, 0x75432610, 0x75432061, 0x75432160, 0x75432106,
+    0x76543210, 0x76054321, 0x76154320, 0x76105432, 0x76254310, 0x76205431, 0x76215430, 0x76210543,
+    0x76354210, 0x76305421, 0x76315420, 0x76310542, 0x76325410, 0x76320541, 0x76321540, 0x76321054,
+    0x76453210, 0x76405321, 0x76415320, 0x76410532, 0x76425310, 0x76420531, 0x76421530, 0x76421053,
+    0x76435210, 0x76430521, 0x76431520, 0x76431052, 0x76432510, 0x76432051, 0x76432150, 0x76432105,
+    0x76543210, 0x76504321, 0x76514320, 0x76510432, 0x76524310, 0x76520431, 0x76521430, 0x76521043,
+    0x76534210, 0x76530421, 0x76531420, 0x76531042, 0x76532410, 0x76532041, 0x76532140, 0x76532104,
+    0x76543210, 0x76540321, 0x76541320, 0x76541032, 0x76542310, 0x76542031, 0x76542130, 0x76542103,
+    0x76543210, 0x76543021, 0x76543120, 0x76543102, 0x76543210, 0x76543201, 0x76543210, 0x76543210,
+};
+
+// The same for 4 lanes of 64 bits, as pairs of 32-bit lane indices
+static const uint32_t sort_avx2_i64_perm[16] = {
+    0x76543210, 0x10765432, 0x32765410, 0x32107654, 0x54763210, 0x54107632, 0x54327610, 0x54321076,
+    0x76543210, 0x76105432, 0x76325410, 0x76321054, 0x76543210, 0x76541032, 0x76543210, 0x76543210,
+};
+
+// Function to take the minimum of lanes p and v where imm has a 0 bit and the maximum where it has a 1 bit
+#define SORT_AVX2_I32_STEP(v, p, imm) \
+    _mm256_blend_epi32(_mm256_min_epi32((v), (p)), _mm256_max_epi32((v), (p)), (imm))
+
+// Function to unpack a nibble-packed permutation into a vector of 32-bit lane indices
+static inline SORT_AVX2 __m256i sort_avx2_perm(uint32_t packed) {
+    __m256i indices = _mm256_srlv_epi32(_mm256_set1_epi32((int)packed), _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28));
+    return _mm256_and_si256(indices, _mm256_set1_epi32(0xF));
+}
+
+// Function to reverse the lanes of a vector of 8 int32
+static inline SORT_AVX2 __m256i sort_avx2_i32_reverse(__m256i v) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// Function to sort the lanes of a vector of 8 int32 with a bitonic network. Every merge compares lane i with its
+// mirror in the merged block first, so all comparators point the same way and the lane masks are fixed.
+static inline SORT_AVX2 __m256i sort_avx2_i32_vector(__m256i v) {
+    v = SORT_AVX2_I32_STEP(v, _mm256_shuffle_epi32(v, 0xB1), 0xAA);
+    v = SORT_AVX2_I32_STEP(v, _mm256_shuffle_epi32(v, 0x1B), 0xCC);
+    v = SORT_AVX2_I32_STEP(v, _mm256_shuffle_epi32(v, 0xB1), 0xAA);
+    v = SORT_AVX2_I32_STEP(v, sort_avx2_i32_reverse(v), 0xF0);
+    v = SORT_AVX2_I32_STEP(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+    v = SORT_AVX2_I32_STEP(v, _mm256_shuffle_epi32(v, 0xB1), 0xAA);
+    return v;
+}
+
+// Function to finish a bitonic merge inside a vector of 8 int32, comparing lanes 4, 2 and 1 apart
+static inline SORT_AVX2 __m256i sort_avx2_i32_clean(__m256i v) {
+    v = SORT_AVX2_I32_STEP(v, _mm256_permute2x128_si256(v, v, 0x01), 0xF0);
+    v = SORT_AVX2_I32_STEP(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+    v = SORT_AVX2_I32_STEP(v, _mm256_shuffle_epi32(v, 0xB1), 0xAA);
+    return v;
+}
+
+// Function to sort at most SORT_AVX2_I32_BLOCK keys: the keys are padded with INT32_MAX to a power of two of
+// vectors, each vector is sorted, then sorted groups of vectors are merged pairwise by the same bitonic network
+static SORT_AVX2 void sort_avx2_i32_block(int32_t *data, size_t n) {
+    int32_t keys[SORT_AVX2_I32_BLOCK];
+    __m256i v[SORT_AVX2_BLOCK_VECTORS];
+    size_t m = 1;
+
+    while (m * 8 < n) {
+        m <<= 1;
+    }
+    memcpy(keys, data, n * sizeof(int32_t));
+    for (size_t i = n; i < m * 8; i++) {
+        keys[i] = INT32_MAX;
+    }
+    for (size_t i = 0; i < m; i++) {
+        v[i] = sort_avx2_i32_vector(_mm256_loadu_si256((const __m256i *)(keys + i * 8)));
+    }
+
+    for (size_t w = 1; w < m; w <<= 1) {
+        for (size_t base = 0; base < m; base += 2 * w) {
+            for (size_t i = 0; i < w; i++) {
+                __m256i a = v[base + i];
+                __m256i b = sort_avx2_i32_reverse(v[base + 2 * w - 1 - i]);
+                v[base + i] = _mm256_min_epi32(a, b);
+                v[base + 2 * w - 1 - i] = sort_avx2_i32_reverse(_mm256_max_epi32(a, b));
+            }
+            for (size_t d = w / 2; d > 0; d >>= 1) {
+                for (size_t j = base; j < base + 2 * w; j += 2 * d) {
+                    for (size_t i = j; i < j + d; i++) {
+                        __m256i a = v[i];
+                        v[i] = _mm256_min_epi32(a, v[i + d]);
+                        v[i + d] = _mm256_max_epi32(a, v[i + d]);
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < m; i++) {
+            v[i] = sort_avx2_i32_clean(v[i]);
+        }
+    }
+
+    for (size_t i = 0; i < m; i++) {
+        _mm256_storeu_si256((__m256i *)(keys + i * 8), v[i]);
+    }
+    memcpy(data, keys, n * sizeof(int32_t));
+}
+
+// Function to split one vector around the pivot, writing its smaller lanes at *left and its larger ones below *right
+#define SORT_AVX2_I32_SPLIT(data, v, pivot, left, right) do {                                     \
+    unsigned mask_ = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32((v), (pivot)))); \
+    __m256i split_ = _mm256_permutevar8x32_epi32((v), sort_avx2_perm(sort_avx2_i32_perm[mask_]));    \
+    size_t greater_ = (size_t)__builtin_popcount(mask_);                                         \
+    _mm256_storeu_si256((__m256i *)((data) + (left)), split_);                                   \
+    _mm256_storeu_si256((__m256i *)((data) + (right) - 8), split_);                              \
+    (left) += 8 - greater_;                                                                      \
+    (right) -= greater_;                                                                         \
+} while (0)
+
+// Function to partition n > 2 * 8 keys in place into those at most pivot followed by the greater ones,
+// returning the number of the former. The first and last vectors are held in registers, which leaves a vector
+// of room at each end; every vector read comes from the side with less room, so both full-width stores of a
+// split land in space already read.
+static SORT_AVX2 size_t sort_avx2_i32_partition(int32_t *data, size_t n, int32_t pivot) {
+    const __m256i p = _mm256_set1_epi32(pivot);
+    __m256i first = _mm256_loadu_si256((const __m256i *)data);
+    __m256i last = _mm256_loadu_si256((const __m256i *)(data + n - 8));
+    size_t left = 0;
+    size_t right = n;
+    size_t read_left = 8;
+    size_t read_right = n - 8;
+    int32_t tail[8];
+    size_t tail_n = (read_right - read_left) % 8;
+
+    // Keys that do not fill a vector are set aside and placed one by one at the end
+    read_right -= tail_n;
+    memcpy(tail, data + read_right, tail_n * sizeof(int32_t));
+
+    while (read_left < read_right) {
+        __m256i v;
+        if (read_left - left <= right - read_right) {
+            v = _mm256_loadu_si256((const __m256i *)(data + read_left));
+            read_left += 8;
+        } else {
+            read_right -= 8;
+            v = _mm256_loadu_si256((const __m256i *)(data + read_right));
+        }
+        SORT_AVX2_I32_SPLIT(data, v, p, left, right);
+    }
+    for (size_t i = 0; i < tail_n; i++) {
+        if (tail[i] > pivot) {
+            data[--right] = tail[i];
+        } else {
+            data[left++] = tail[i];
+        }
+    }
+    SORT_AVX2_I32_SPLIT(data, first, p, left, right);
+    SORT_AVX2_I32_SPLIT(data, last, p, left, right);
+    return left;
+}
+
+// Functions to get the median of three keys
+static inline int32_t sort_median3_i32(int32_t a, int32_t b, int32_t c) {
+    return a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+}
+
+static inline int64_t sort_median3_i64(int64_t a, int64_t b, int64_t c) {
+    return a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+}
+
+// Function to sort int32 keys with vectorized partitions down to blocks sorted by bitonic networks.
+// Ranges are [low, high) here. A pivot equal to the largest key of its range sends every key left; the range
+// is then split into the keys below the pivot and those equal to it, which are in place.
+static SORT_AVX2 void sort_avx2_i32(int32_t *data, size_t n) {
+    SortRange stack[SORT_STACK_SIZE];
+    size_t top = 0;
+    size_t depth = 0;
+
+    for (size_t m = n; m > 1; m >>= 1) {
+        depth += 2;
+    }
+    stack[top++] = (SortRange){0, n, depth};
+    while (top > 0) {
+        SortRange range = stack[--top];
+        size_t low = range.low;
+        size_t high = range.high;
+        depth = range.depth;
+
+        while (high - low > SORT_AVX2_I32_BLOCK) {
+            size_t len = high - low;
+            if (depth == 0) {
+                sort_scalar_i32_sort_heap(data + low, len);
+                low = high;
+                break;
+            }
+            depth--;
+
+            int32_t *range_data = data + low;
+            size_t step = len / 8;
+            int32_t pivot = sort_median3_i32(
+                sort_median3_i32(range_data[0], range_data[step], range_data[2 * step]),
+                sort_median3_i32(range_data[len / 2 - step], range_data[len / 2], range_data[len / 2 + step]),
+                sort_median3_i32(range_data[len - 1 - 2 * step], range_data[len - 1 - step], range_data[len - 1]));
+            size_t mid = low + sort_avx2_i32_partition(range_data, len, pivot);
+
+            if (mid == high) {
+                high = pivot == INT32_MIN ? low : low + sort_avx2_i32_partition(range_data, len, pivot - 1);
+                continue;
+            }
+            // Defer the larger side and keep working on the smaller one
+            if (mid - low > high - mid) {
+                stack[top++] = (SortRange){low, mid, depth};
+                low = mid;
+            } else {
+                stack[top++] = (SortRange){mid, high, depth};
+                high = mid;
+            }
+        }
+        if (high - low > 1) {
+            sort_avx2_i32_block(data + low, high - low);
+        }
+    }
+}
+
+// Function to take the minimum and the maximum of the 64-bit lanes of a and b; AVX2 has no 64-bit min or max
+#define SORT_AVX2_I64_MIN(a, b) _mm256_blendv_epi8((a), (b), _mm256_cmpgt_epi64((a), (b)))
+#define SORT_AVX2_I64_MAX(a, b) _mm256_blendv_epi8((b), (a), _mm256_cmpgt_epi64((a), (b)))
+
+// Function to take the minimum of lanes p and v where imm has 0 bits and the maximum where it has 1 bits;
+// imm has two bits per 64-bit lane
+#define SORT_AVX2_I64_STEP(v, p, imm) \
+    _mm256_blend_epi32(SORT_AVX2_I64_MIN((v), (p)), SORT_AVX2_I64_MAX((v), (p)), (imm))
+
+// Function to reverse the lanes of a vector of 4 int64
+static inline SORT_AVX2 __m256i sort_avx2_i64_reverse(__m256i v) {
+    return _mm256_permute4x64_epi64(v, 0x1B);
+}
+
+// Function to sort the lanes of a vector of 4 int64 with the same network as sort_avx2_i32_vector
+static inline SORT_AVX2 __m256i sort_avx2_i64_vector(__m256i v) {
+    v = SORT_AVX2_I64_STEP(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+    v = SORT_AVX2_I64_STEP(v, sort_avx2_i64_reverse(v), 0xF0);
+    v = SORT_AVX2_I64_STEP(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+    return v;
+}
+
+// Function to finish a bitonic merge inside a vector of 4 int64, comparing lanes 2 and 1 apart
+static inline SORT_AVX2 __m256i sort_avx2_i64_clean(__m256i v) {
+    v = SORT_AVX2_I64_STEP(v, _mm256_permute4x64_epi64(v, 0x4E), 0xF0);
+    v = SORT_AVX2_I64_STEP(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+    return v;
+}
+
+// Function to sort at most SORT_AVX2_I64_BLOCK keys like sort_avx2_i32_block
+static SORT_AVX2 void sort_avx2_i64_block(int64_t *data, size_t n) {
+    int64_t keys[SORT_AVX2_I64_BLOCK];
+    __m256i v[SORT_AVX2_BLOCK_VECTORS];
+    size_t m = 1;
+
+    while (m * 4 < n) {
+        m <<= 1;
+    }
+    memcpy(keys, data, n * sizeof(int64_t));
+    for (size_t i = n; i < m * 4; i++) {
+        keys[i] = INT64_MAX;
+    }
+    for (size_t i = 0; i < m; i++) {
+        v[i] = sort_avx2_i64_vector(_mm256_loadu_si256((const __m256i *)(keys + i * 4)));
+    }
+
+    for (size_t w = 1; w < m; w <<= 1) {
+        for (size_t base = 0; base < m; base += 2 * w) {
+            for (size_t i = 0; i < w; i++) {
+                __m256i a = v[base + i];
+                __m256i b = sort_avx2_i64_reverse(v[base + 2 * w - 1 - i]);
+                v[base + i] = SORT_AVX2_I64_MIN(a, b);
+                v[base + 2 * w - 1 - i] = sort_avx2_i64_reverse(SORT_AVX2_I64_MAX(a, b));
+            }
+            for (size_t d = w / 2; d > 0; d >>= 1) {
+                for (size_t j = base; j < base + 2 * w; j += 2 * d) {
+                    for (size_t i = j; i < j + d; i++) {
+                        __m256i a = v[i];
+                        v[i] = SORT_AVX2_I64_MIN(a, v[i + d]);
+                        v[i + d] = SORT_AVX2_I64_MAX(a, v[i + d]);
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < m; i++) {
+            v[i] = sort_avx2_i64_clean(v[i]);
+        }
+    }
+
+    for (size_t i = 0; i < m; i++) {
+        _mm256_storeu_si256((__m256i *)(keys + i * 4), v[i]);
+    }
+    memcpy(data, keys, n * sizeof(int64_t));
+}
+
+// Function to split one vector of 4 int64 around the pivot like SORT_AVX2_I32_SPLIT
+#define SORT_AVX2_I64_SPLIT(data, v, pivot, left, right) do {                                     \
+    unsigned mask_ = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64((v), (pivot)))); \
+    __m256i split_ = _mm256_permutevar8x32_epi32((v), sort_avx2_perm(sort_avx2_i64_perm[mask_]));    \
+    size_t greater_ = (size_t)__builtin_popcount(mask_);                                         \
+    _mm256_storeu_si256((__m256i *)((data) + (left)), split_);                                   \
+    _mm256_storeu_si256((__m256i *)((data) + (right) - 4), split_);                              \
+    (left) += 4 - greater_;                                                                      \
+    (right) -= greater_;                                                                         \
+} while (0)
+
+// Function to partition n > 2 * 4 keys in place like sort_avx2_i32_partition
+static SORT_AVX2 size_t sort_avx2_i64_partition(int64_t *data, size_t n, int64_t pivot) {
+    const __m256i p = _mm256_set1_epi64x(pivot);
+    __m256i first = _mm256_loadu_si256((const __m256i *)data);
+    __m256i last = _mm256_loadu_si256((const __m256i *)(data + n - 4));
+    size_t left = 0;
+    size_t right = n;
+    size_t read_left = 4;
+    size_t read_right = n - 4;
+    int64_t tail[4];
+    size_t tail_n = (read_right - read_left) % 4;
+
+    read_right -= tail_n;
+    memcpy(tail, data + read_right, tail_n * sizeof(int64_t));
+
+    while (read_left < read_right) {
+        __m256i v;
+        if (read_left - left <= right - read_right) {
+            v = _mm256_loadu_si256((const __m256i *)(data + read_left));
+            read_left += 4;
+        } else {
+            read_right -= 4;
+            v = _mm256_loadu_si256((const __m256i *)(data + read_right));
+        }
+        SORT_AVX2_I64_SPLIT(data, v, p, left, right);
+    }
+    for (size_t i = 0; i < tail_n; i++) {
+        if (tail[i] > pivot) {
+            data[--right] = tail[i];
+        } else {
+            data[left++] = tail[i];
+        }
+    }
+    SORT_AVX2_I64_SPLIT(data, first, p, left, right);
+    SORT_AVX2_I64_SPLIT(data, last, p, left, right);
+    return left;
+}
+
+// Function to sort int64 keys like sort_avx2_i32
+static SORT_AVX2 void sort_avx2_i64(int64_t *data, size_t n) {
+    SortRange stack[SORT_STACK_SIZE];
+    size_t top = 0;
+    size_t depth = 0;
+
+    for (size_t m = n; m > 1; m >>= 1) {
+        depth += 2;
+    }
+    stack[top++] = (SortRange){0, n, depth};
+    while (top > 0) {
+        SortRange range = stack[--top];
+        size_t low = range.low;
+        size_t high = range.high;
+        depth = range.depth;
+
+        while (high - low > SORT_AVX2_I64_BLOCK) {
+            size_t len = high - low;
+            if (depth == 0) {
+                sort_scalar_i64_sort_heap(data + low, len);
+                low = high;
+                break;
+            }
+            depth--;
+
+            int64_t *range_data = data + low;
+            size_t step = len / 8;
+            int64_t pivot = sort_median3_i64(
+                sort_median3_i64(range_data[0], range_data[step], range_data[2 * step]),
+                sort_median3_i64(range_data[len / 2 - step], range_data[len / 2], range_data[len / 2 + step]),
+                sort_median3_i64(range_data[len - 1 - 2 * step], range_data[len - 1 - step], range_data[len - 1]));
+            size_t mid = low + sort_avx2_i64_partition(range_data, len, pivot);
+
+            if (mid == high) {
+                high = pivot == INT64_MIN ? low : low + sort_avx2_i64_partition(range_data, len, pivot - 1);
+                continue;
+            }
+            if (mid - low > high - mid) {
+                stack[top++] = (SortRange){low, mid, depth};
+                low = mid;
+            } else {
+                stack[top++] = (SortRange){mid, high, depth};
+                high = mid;
+            }
+        }
+        if (high - low > 1) {
+            sort_avx2_i64_block(data + low, high - low);
+        }
+    }
+}
+
+// Function to check whether the CPU runs the AVX2 kernels
+static BOOL sort_has_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+
+#endif /* SORT_SIMD_AVX2 */
+
+// Function to sort int32 keys in place, with AVX2 kernels when the CPU has them
+void sort_int32(int32_t *data, size_t n) {
+    if (data == NULL || n < 2) {
+        return;
+    }
+#ifdef SORT_SIMD_AVX2
+    if (sort_has_avx2()) {
+        sort_avx2_i32(data, n);
+        return;
+    }
+#endif
+    sort_scalar_i32_sort(data, n);
+}
+
+// Function to sort uint64 keys in place, with AVX2 kernels when the CPU has them
+void sort_uint64(uint64_t *data, size_t n) {
+    if (data == NULL || n < 2) {
+        return;
+    }
+#ifdef SORT_SIMD_AVX2
+    if (sort_has_avx2()) {
+        // AVX2 only compares signed 64-bit lanes; flipping the top bit maps unsigned order onto signed order
+        for (size_t i = 0; i < n; i++) {
+            data[i] ^= (uint64_t)1 << 63;
+        }
+        sort_avx2_i64((int64_t *)data, n);
+        for (size_t i = 0; i < n; i++) {
+            data[i] ^= (uint64_t)1 << 63;
+        }
+        return;
+    }
+#endif
+    sort_scalar_u64_sort(data, n);
+}
+
+// Function to sort float keys in place, with AVX2 kernels when the CPU has them
+void sort_float(float *data, size_t n) {
+    if (data == NULL || n < 2) {
+        return;
+    }
+    sort_float_keys(data, n);
+    sort_int32((int32_t *)data, n);
+    sort_float_keys(data, n);
+}
+
+// partial_sort_ptr selects with a bounded heap while k is at most 1 / PARTIAL_SORT_HEAP_RATIO of n,
+// and with nth_element_ptr followed by a sort of the first k above that
+#define PARTIAL_SORT_HEAP_RATIO 128
+
+// Function to move the element at node up a max-heap of pointers until its parent is not smaller
+static void sort_ptr_sift_up(void **data, size_t node, SortCmpFunc cmp) {
+    void *current = data[node];
+    while (node > 0) {
+        size_t parent = (node - 1) / 2;
+        if (cmp(data[parent], current) >= 0) {
+            break;
+        }
+        data[node] = data[parent];
+        node = parent;
+    }
+    data[node] = current;
+}
+
+// Function to reorder an array of pointers so that data[nth] is the element a full sort would put there (introselect)
+void nth_element_ptr(void **data, size_t n, size_t nth, SortCmpFunc cmp) {
+    size_t low = 0;
+    size_t high = n - 1;
+    size_t depth = 0;
+
+    if (data == NULL || cmp == NULL || nth >= n) {
+        return;
+    }
+
+    for (size_t m = n; m > 1; m >>= 1) {
+        depth += 2;
+    }
+
+    // Only the side holding nth is partitioned further, so the expected work is linear
+    while (high - low + 1 > SORT_INSERTION_THRESHOLD) {
+        if (depth == 0) {
+            sort_ptr_heap(data + low, high - low + 1, cmp);
+            return;
+        }
+        depth--;
+
+        size_t mid = sort_ptr_partition(data, low, high, cmp);
+        if (mid == nth) {
+            return;
+        } else if (nth < mid) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    sort_ptr_insertion(data, low, high, cmp);
+}
+
+// Function to move the k smallest pointers of a range, in sorted order, to its front
+void partial_sort_ptr(void **data, size_t n, size_t k, SortCmpFunc cmp) {
+    if (data == NULL || cmp == NULL || k == 0) {
+        return;
+    }
+    if (k >= n) {
+        quick_sort_ptr(data, n, cmp);
+        return;
+    }
+
+    if (k > n / PARTIAL_SORT_HEAP_RATIO) {
+        nth_element_ptr(data, n, k - 1, cmp);
+        quick_sort_ptr(data, k - 1, cmp);
+        return;
+    }
+
+    // Keep the k smallest seen so far in a max-heap at the front; an element only enters
+    // when it beats the largest of them, which on random input gets rarer as the scan goes on
+    for (size_t i = k / 2; i > 0; i--) {
+        sort_ptr_sift_down(data, i - 1, k, cmp);
+    }
+    for (size_t i = k; i < n; i++) {
+        if (cmp(data[i], data[0]) < 0) {
+            void *tmp = data[0];
+            data[0] = data[i];
+            data[i] = tmp;
+            sort_ptr_sift_down(data, 0, k, cmp);
+        }
+    }
+    sort_ptr_heap_sorted(data, k, cmp);
+}
+
+// Function to copy the k smallest of n pointers, in sorted order, to out without reordering data
+size_t top_k_ptr(void **data, size_t n, void **out, size_t k, SortCmpFunc cmp) {
+    size_t size = 0;
+
+    if (data == NULL || out == NULL || cmp == NULL || k == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (size < k) {
+            out[size] = data[i];
+            sort_ptr_sift_up(out, size++, cmp);
+        } else if (cmp(data[i], out[0]) < 0) {
+            out[0] = data[i];
+            sort_ptr_sift_down(out, 0, k, cmp);
+        }
+    }
+    sort_ptr_heap_sorted(out, size, cmp);
+    return size;
+}
+
+// Runs shorter than this are extended with binary insertion sort before merging
+#define TIM_SORT_MIN_MERGE 64
+
+// Number of consecutive wins by one run after which merges switch to galloping
+#define TIM_SORT_MIN_GALLOP 7
+
+// The run stack invariants keep run lengths growing at least like Fibonacci numbers, so 85 runs cover 2^64 elements
+#define TIM_SORT_MAX_RUNS 85
+
+// Structure representing a sorted run waiting to be merged
+typedef struct {
+    void **base;
+    size_t len;
+} TimSortRun;
+
+// Structure representing the state of one tim_sort_ptr call
+typedef struct {
+    SortCmpFunc cmp;
+    size_t min_gallop;          // Adaptive galloping threshold, raised when galloping does not pay off
+    void **tmp;                 // Buffer holding the shorter run of a merge, at most n / 2 pointers
+    size_t tmp_size;
+    TimSortRun runs[TIM_SORT_MAX_RUNS];
+    size_t run_n;
+} TimSortState;
+
+// Function to check whether a orders strictly before b
+#define TIM_LESS(state, a, b) ((state)->cmp((a), (b)) < 0)
+
+// Function to get the run length at which to start merging: between 32 and 64, and chosen so that
+// n / min_run is a power of two or slightly less, which keeps the final merges balanced
+static size_t tim_sort_min_run(size_t n) {
+    size_t r = 0;
+    while (n >= TIM_SORT_MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// Function to sort data[0, n) with binary insertion sort, knowing that data[0, start) is already sorted.
+// Equal elements are inserted after each other, which keeps the sort stable.
+static void tim_sort_binary_insertion(void **data, size_t n, size_t start, SortCmpFunc cmp) {
+    for (; start < n; start++) {
+        void *pivot = data[start];
+        size_t low = 0;
+        size_t high = start;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (cmp(pivot, data[mid]) < 0) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        memmove(data + low + 1, data + low, (start - low) * sizeof(void *));
+        data[low] = pivot;
+    }
+}
+
+// Function to get the length of the run starting at data[0], reversing it in place when it is
+// strictly descending (strictly, so that reversing never reorders equal elements)
+static size_t tim_sort_count_run(void **data, size_t n, SortCmpFunc cmp) {
+    size_t len = 2;
+    if (n < 2) {
+        return n;
+    }
+    if (cmp(data[1], data[0]) < 0) {
+        while (len < n && cmp(data[len], data[len - 1]) < 0) {
+            len++;
+        }
+        for (size_t i = 0, j = len - 1; i < j; i++, j--) {
+            void *tmp = data[i];
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+    } else {
+        while (len < n && cmp(data[len], data[len - 1]) >= 0) {
+            len++;
+        }
+    }
+    return len;
+}
+
+// Function to find where key goes in the sorted data[0, n), before any equal elements, searching outward
+// from data[hint] in steps of 1, 3, 7, 15... and then bisecting the last step
+static size_t tim_sort_gallop_left(TimSortState *state, void *key, void **data, size_t n, size_t hint) {
+    size_t last_ofs = 0;
+    size_t ofs = 1;
+
+    if (TIM_LESS(state, data[hint], key)) {
+        // data[hint] < key: gallop right until data[hint + last_ofs] < key <= data[hint + ofs]
+        size_t max_ofs = n - hint;
+        while (ofs < max_ofs && TIM_LESS(state, data[hint + ofs], key)) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        ofs = ofs < max_ofs ? ofs : max_ofs;
+        last_ofs += hint + 1;
+        ofs += hint;
+    } else {
+        // key <= data[hint]: gallop left until data[hint - ofs] < key <= data[hint - last_ofs]
+        size_t max_ofs = hint + 1;
+        while (ofs < max_ofs && !TIM_LESS(state, data[hint - ofs], key)) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        ofs = ofs < max_ofs ? ofs : max_ofs;
+        size_t k = last_ofs;
+        last_ofs = hint + 1 - ofs;
+        ofs = hint - k;
+    }
+
+    // The answer is in [last_ofs, ofs]
+    while (last_ofs < ofs) {
+        size_t mid = last_ofs + ((ofs - last_ofs) >> 1);
+        if (TIM_LESS(state, data[mid], key)) {
+            last_ofs = mid + 1;
+        } else {
+            ofs = mid;
+        }
+    }
+    return ofs;
+}
+
+// Function to find where key goes in the sorted data[0, n), after any equal elements, galloping from data[hint]
+static size_t tim_sort_gallop_right(TimSortState *state, void *key, void **data, size_t n, size_t hint) {
+    size_t last_ofs = 0;
+    size_t ofs = 1;
+
+    if (TIM_LESS(state, key, data[hint])) {
+        // key < data[hint]: gallop left until data[hint - ofs] <= key < data[hint - last_ofs]
+        size_t max_ofs = hint + 1;
+        while (ofs < max_ofs && TIM_LESS(state, key, data[hint - ofs])) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        ofs = ofs < max_ofs ? ofs : max_ofs;
+        size_t k = last_ofs;
+        last_ofs = hint + 1 - ofs;
+        ofs = hint - k;
+    } else {
+        // data[hint] <= key: gallop right until data[hint + last_ofs] <= key < data[hint + ofs]
+        size_t max_ofs = n - hint;
+        while (ofs < max_ofs && !TIM_LESS(state, key, data[hint + ofs])) {
+            last_ofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        ofs = ofs < max_ofs ? ofs : max_ofs;
+        last_ofs += hint + 1;
+        ofs += hint;
+    }
+
+    while (last_ofs < ofs) {
+        size_t mid = last_ofs + ((ofs - last_ofs) >> 1);
+        if (TIM_LESS(state, key, data[mid])) {
+            ofs = mid;
+        } else {
+            last_ofs = mid + 1;
+        }
+    }
+    return ofs;
+}
+
+// Function to make the merge buffer hold at least n pointers
+static int tim_sort_reserve(TimSortState *state, size_t n) {
+    if (n <= state->tmp_size) {
+        return OK;
+    }
+    STL_FREE(state->tmp);
+    if ((state->tmp = (void **)STL_MALLOC(n * sizeof(void *))) == NULL) {
+        state->tmp_size = 0;
+        return ERR_OOM;
+    }
+    state->tmp_size = n;
+    return OK;
+}
+
+// Function to merge the adjacent runs a and b from the left, copying a (the shorter) to the buffer.
+// Expects b[0] < a[0] and a[na - 1] > b[nb - 1], which tim_sort_merge_at establishes.
+static int tim_sort_merge_lo(TimSortState *state, void **a, size_t na, void **b, size_t nb) {
+    if (tim_sort_reserve(state, na) != OK) {
+        return ERR_OOM;
+    }
+    void **dest = a;
+    memcpy(state->tmp, a, na * sizeof(void *));
+    a = state->tmp;
+    size_t min_gallop = state->min_gallop;
+
+    *dest++ = *b++;
+    if (--nb == 0) {
+        goto done;
+    }
+    if (na == 1) {
+        goto copy_b;
+    }
+
+    for (;;) {
+        size_t a_wins = 0;
+        size_t b_wins = 0;
+
+        // One element at a time until one run keeps winning
+        for (;;) {
+            if (TIM_LESS(state, *b, *a)) {
+                *dest++ = *b++;
+                b_wins++;
+                a_wins = 0;
+                if (--nb == 0) {
+                    goto done;
+                }
+                if (b_wins >= min_gallop) {
+                    break;
+                }
+            } else {
+                *dest++ = *a++;
+                a_wins++;
+                b_wins = 0;
+                if (--na == 1) {
+                    goto copy_b;
+                }
+                if (a_wins >= min_gallop) {
+                    break;
+                }
+            }
+        }
+
+        // Gallop: move whole blocks while either run wins by TIM_SORT_MIN_GALLOP or more
+        min_gallop++;
+        do {
+            min_gallop -= min_gallop > 1;
+            state->min_gallop = min_gallop;
+
+            a_wins = tim_sort_gallop_right(state, *b, a, na, 0);
+            if (a_wins > 0) {
+                memcpy(dest, a, a_wins * sizeof(void *));
+                dest += a_wins;
+                a += a_wins;
+                na -= a_wins;
+                if (na == 1) {
+                    goto copy_b;
+                }
+                // na reaches 0 only with a comparator that is not a consistent ordering
+                if (na == 0) {
+                    goto done;
+                }
+            }
+            *dest++ = *b++;
+            if (--nb == 0) {
+                goto done;
+            }
+
+            b_wins = tim_sort_gallop_left(state, *a, b, nb, 0);
+            if (b_wins > 0) {
+                memmove(dest, b, b_wins * sizeof(void *));
+                dest += b_wins;
+                b += b_wins;
+                nb -= b_wins;
+                if (nb == 0) {
+                    goto done;
+                }
+            }
+            *dest++ = *a++;
+            if (--na == 1) {
+                goto copy_b;
+            }
+        } while (a_wins >= TIM_SORT_MIN_GALLOP || b_wins >= TIM_SORT_MIN_GALLOP);
+        // Galloping stopped paying off, make it harder to enter again
+        min_gallop++;
+        state->min_gallop = min_gallop;
+    }
+
+done:
+    memcpy(dest, a, na * sizeof(void *));
+    return OK;
+
+copy_b:
+    // The last element of a is greater than everything left in b
+    memmove(dest, b, nb * sizeof(void *));
+    dest[nb] = *a;
+    return OK;
+}
+
+// Function to merge the adjacent runs a and b from the right, copying b (the shorter) to the buffer.
+// Expects b[0] < a[0] and a[na - 1] > b[nb - 1], which tim_sort_merge_at establishes.
+static int tim_sort_merge_hi(TimSortState *state, void **a, size_t na, void **b, size_t nb) {
+    if (tim_sort_reserve(state, nb) != OK) {
+        return ERR_OOM;
+    }
+    void **dest = b + nb - 1;
+    void **base_a = a;
+    void **base_b = state->tmp;
+    memcpy(base_b, b, nb * sizeof(void *));
+    a += na - 1;
+    b = base_b + nb - 1;
+    size_t min_gallop = state->min_gallop;
+
+    *dest-- = *a--;
+    if (--na == 0) {
+        goto done;
+    }
+    if (nb == 1) {
+        goto copy_a;
+    }
+
+    for (;;) {
+        size_t a_wins = 0;
+        size_t b_wins = 0;
+
+        for (;;) {
+            if (TIM_LESS(state, *b, *a)) {
+                *dest-- = *a--;
+                a_wins++;
+                b_wins = 0;
+                if (--na == 0) {
+                    goto done;
+                }
+                if (a_wins >= min_gallop) {
+                    break;
+                }
+            } else {
+                *dest-- = *b--;
+                b_wins++;
+                a_wins = 0;
+                if (--nb == 1) {
+                    goto copy_a;
+                }
+                if (b_wins >= min_gallop) {
+                    break;
+                }
+            }
+        }
+
+        min_gallop++;
+        do {
+            min_gallop -= min_gallop > 1;
+            state->min_gallop = min_gallop;
+
+            a_wins = na - tim_sort_gallop_right(state, *b, base_a, na, na - 1);
+            if (a_wins > 0) {
+                dest -= a_wins;
+                a -= a_wins;
+                memmove(dest + 1, a + 1, a_wins * sizeof(void *));
+                na -= a_wins;
+                if (na == 0) {
+                    goto done;
+                }
+            }
+            *dest-- = *b--;
+            if (--nb == 1) {
+                goto copy_a;
+            }
+            // nb reaches 0 only with a comparator that is not a consistent ordering
+            if (nb == 0) {
+                goto done;
+            }
+
+            b_wins = nb - tim_sort_gallop_left(state, *a, base_b, nb, nb - 1);
+            if (b_wins > 0) {
+                dest -= b_wins;
+                b -= b_wins;
+                memcpy(dest + 1, b + 1, b_wins * sizeof(void *));
+                nb -= b_wins;
+                if (nb == 1) {
+                    goto copy_a;
+                }
+                if (nb == 0) {
+                    goto done;
+                }
+            }
+            *dest-- = *a--;
+            if (--na == 0) {
+                goto done;
+            }
+        } while (a_wins >= TIM_SORT_MIN_GALLOP || b_wins >= TIM_SORT_MIN_GALLOP);
+        min_gallop++;
+        state->min_gallop = min_gallop;
+    }
+
+done:
+    memcpy(dest + 1 - nb, base_b, nb * sizeof(void *));
+    return OK;
+
+copy_a:
+    // The first element of b is smaller than everything left in a
+    dest -= na;
+    a -= na;
+    memmove(dest + 1, a + 1, na * sizeof(void *));
+    *dest = *b;
+    return OK;
+}
+
+// Function to merge the runs at positions i and i + 1 of the run stack
+static int tim_sort_merge_at(TimSortState *state, size_t i) {
+    void **a = state->runs[i].base;
+    size_t na = state->runs[i].len;
+    void **b = state->runs[i + 1].base;
+    size_t nb = state->runs[i + 1].len;
+
+    state->runs[i].len = na + nb;
+    if (i + 3 == state->run_n) {
+        state->runs[i + 1] = state->runs[i + 2];
+    }
+    state->run_n--;
+
+    // Elements of a that are not greater than b[0] are already in place
+    size_t k = tim_sort_gallop_right(state, *b, a, na, 0);
+    a += k;
+    na -= k;
+    if (na == 0) {
+        return OK;
+    }
+    // And so are elements of b not smaller than the last of a
+    nb = tim_sort_gallop_left(state, a[na - 1], b, nb, nb - 1);
+    if (nb == 0) {
+        return OK;
+    }
+    return na <= nb ? tim_sort_merge_lo(state, a, na, b, nb) : tim_sort_merge_hi(state, a, na, b, nb);
+}
+
+// Function to merge runs until the stack invariants hold again: every run is longer than the next
+// one, and than the next two combined. Checking one entry deeper than the original TimSort follows
+// the fix by de Gouw et al. (2015), without which the invariants can break on long inputs.
+static int tim_sort_merge_collapse(TimSortState *state) {
+    while (state->run_n > 1) {
+        size_t n = state->run_n - 2;
+        TimSortRun *runs = state->runs;
+        if ((n > 0 && runs[n - 1].len <= runs[n].len + runs[n + 1].len)
+            || (n > 1 && runs[n - 2].len <= runs[n - 1].len + runs[n].len)) {
+            if (runs[n - 1].len < runs[n + 1].len) {
+                n--;
+            }
+        } else if (runs[n].len > runs[n + 1].len) {
+            break;
+        }
+        if (tim_sort_merge_at(state, n) != OK) {
+            return ERR_OOM;
+        }
+    }
+    return OK;
+}
+
+// Function to merge all remaining runs at the end of the sort
+static int tim_sort_merge_force_collapse(TimSortState *state) {
+    while (state->run_n > 1) {
+        size_t n = state->run_n - 2;
+        if (n > 0 && state->runs[n - 1].len < state->runs[n + 1].len) {
+            n--;
+        }
+        if (tim_sort_merge_at(state, n) != OK) {
+            return ERR_OOM;
+        }
+    }
+    return OK;
+}
+
+// Function to sort an array of pointers stably, calling only the comparator (TimSort)
+int tim_sort_ptr(void **data, size_t n, SortCmpFunc cmp) {
+    TimSortState state;
+    int ret = OK;
+
+    if (data == NULL || cmp == NULL) {
+        return ERR_NIL;
+    }
+    if (n < 2) {
+        return OK;
+    }
+
+    state.cmp = cmp;
+    state.min_gallop = TIM_SORT_MIN_GALLOP;
+    state.tmp = NULL;
+    state.tmp_size = 0;
+    state.run_n = 0;
+
+    size_t min_run = tim_sort_min_run(n);
+    void **low = data;
+    size_t remaining = n;
+    while (remaining > 0) {
+        size_t len = tim_sort_count_run(low, remaining, cmp);
+        // Extend a short run to min_run elements, or to the end of the data
+        if (len < min_run) {
+            size_t forced = remaining < min_run ? remaining : min_run;
+            tim_sort_binary_insertion(low, forced, len, cmp);
+            len = forced;
+        }
+        state.runs[state.run_n].base = low;
+        state.runs[state.run_n].len = len;
+        state.run_n++;
+        if ((ret = tim_sort_merge_collapse(&state)) != OK) {
+            break;
+        }
+        low += len;
+        remaining -= len;
+    }
+    if (ret == OK) {
+        ret = tim_sort_merge_force_collapse(&state);
+    }
+    STL_FREE(state.tmp);
+    return ret;
+}
+
+// Number of bits sorted per radix pass, and the number of buckets they select. 11 bits sorts a 64-bit
+// key in 6 passes while the 2048 bucket write positions still stay in the L1 and L2 caches
+#define RADIX_SORT_BITS 11
+#define RADIX_SORT_BUCKETS (1 << RADIX_SORT_BITS)
+#define RADIX_SORT_PASSES ((64 + RADIX_SORT_BITS - 1) / RADIX_SORT_BITS)
+
+// Below this many elements the pairs are sorted by insertion instead of by radix passes
+#define RADIX_SORT_INSERTION_THRESHOLD 64
+
+// Kinds of key a radix sort extracts, each mapped to an unsigned integer with the same order
+typedef enum {
+    RADIX_SORT_UINT64 = 0,
+    RADIX_SORT_INT64,
+    RADIX_SORT_DOUBLE,
+} RadixSortKind;
+
+// Union holding the key function of a radix sort, the member read being the one its RadixSortKind names;
+// function pointers cannot portably pass through void *
+typedef union {
+    SortKeyFunc u64;
+    SortKeyInt64Func i64;
+    SortKeyDoubleFunc d;
+} RadixSortKey;
+
+// Structure representing an element together with its extracted key, so passes never call back
+typedef struct {
+    uint64_t key;
+    void *data;
+} RadixSortPair;
+
+// Function to map a signed key to an unsigned one with the same order: flipping the sign bit
+// moves negative numbers below positive ones
+static inline uint64_t radix_sort_int64_key(int64_t key) {
+    return (uint64_t)key ^ ((uint64_t)1 << 63);
+}
+
+// Function to map a double key to an unsigned one with the same order: positive numbers get the
+// sign bit set, negative numbers have every bit flipped so larger magnitudes sort lower
+static inline uint64_t radix_sort_double_key(double key) {
+    uint64_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+// Function to sort pairs stably by key with insertion sort
+static void radix_sort_insertion(RadixSortPair *pairs, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        RadixSortPair current = pairs[i];
+        size_t j = i;
+        while (j > 0 && pairs[j - 1].key > current.key) {
+            pairs[j] = pairs[j - 1];
+            j--;
+        }
+        pairs[j] = current;
+    }
+}
+
+// Function to extract the keys, sort the pairs by them and write the pointers back in order
+static int radix_sort(void **data, size_t n, RadixSortKind kind, RadixSortKey key, void *ctx) {
+    if (data == NULL) {
+        return ERR_NIL;
+    }
+    if (n < 2) {
+        return OK;
+    }
+
+    RadixSortPair *pairs = (RadixSortPair *)STL_MALLOC(n * sizeof(RadixSortPair));
+    RadixSortPair *tmp = n > RADIX_SORT_INSERTION_THRESHOLD ? (RadixSortPair *)STL_MALLOC(n * sizeof(RadixSortPair)) : NULL;
+    if (pairs == NULL || (tmp == NULL && n > RADIX_SORT_INSERTION_THRESHOLD)) {
+        STL_FREE(pairs);
+        STL_FREE(tmp);
+        return ERR_OOM;
+    }
+
+    // One call per element; the switch sits outside the loops so each loop calls one function type
+    switch (kind) {
+        case RADIX_SORT_UINT64:
+            for (size_t i = 0; i < n; i++) {
+                pairs[i].key = key.u64(ctx, data[i]);
+                pairs[i].data = data[i];
+            }
+            break;
+        case RADIX_SORT_INT64:
+            for (size_t i = 0; i < n; i++) {
+                pairs[i].key = radix_sort_int64_key(key.i64(ctx, data[i]));
+                pairs[i].data = data[i];
+            }
+            break;
+        case RADIX_SORT_DOUBLE:
+            for (size_t i = 0; i < n; i++) {
+                pairs[i].key = radix_sort_double_key(key.d(ctx, data[i]));
+                pairs[i].data = data[i];
+            }
+            break;
+    }
+
+    if (n <= RADIX_SORT_INSERTION_THRESHOLD) {
+        radix_sort_insertion(pairs, n);
+    } else {
+        // Count every digit of every key in a single read of the pairs
+        size_t (*counts)[RADIX_SORT_BUCKETS] = STL_MALLOC(RADIX_SORT_PASSES * sizeof(*counts));
+        if (counts == NULL) {
+            STL_FREE(pairs);
+            STL_FREE(tmp);
+            return ERR_OOM;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t k = pairs[i].key;
+            for (int pass = 0; pass < RADIX_SORT_PASSES; pass++) {
+                counts[pass][(k >> (pass * RADIX_SORT_BITS)) & (RADIX_SORT_BUCKETS - 1)]++;
+            }
+        }
+
+        RadixSortPair *src = pairs;
+        RadixSortPair *dst = tmp;
+        for (int pass = 0; pass < RADIX_SORT_PASSES; pass++) {
+            int shift = pass * RADIX_SORT_BITS;
+            // A digit that is the same in every key would move nothing
+            if (counts[pass][(src[0].key >> shift) & (RADIX_SORT_BUCKETS - 1)] == n) {
+                continue;
+            }
+
+            size_t offsets[RADIX_SORT_BUCKETS];
+            size_t sum = 0;
+            for (int b = 0; b < RADIX_SORT_BUCKETS; b++) {
+                offsets[b] = sum;
+                sum += counts[pass][b];
+            }
+            for (size_t i = 0; i < n; i++) {
+                dst[offsets[(src[i].key >> shift) & (RADIX_SORT_BUCKETS - 1)]++] = src[i];
+            }
+            RadixSortPair *swap = src;
+            src = dst;
+            dst = swap;
+        }
+        STL_FREE(counts);
+        // Passes alternate between the buffers, the result is wherever the last one wrote
+        pairs = src;
+        tmp = dst;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        data[i] = pairs[i].data;
+    }
+    STL_FREE(pairs);
+    STL_FREE(tmp);
+    return OK;
+}
+
+// Function to sort an array of pointers stably by an unsigned 64-bit key
+int radix_sort_ptr(void **data, size_t n, SortKeyFunc key, void *ctx) {
+    if (key == NULL) {
+        return ERR_NIL;
+    }
+    RadixSortKey sort_key = {.u64 = key};
+    return radix_sort(data, n, RADIX_SORT_UINT64, sort_key, ctx);
+}
+
+// Function to sort an array of pointers stably by a signed 64-bit key
+int radix_sort_ptr_int64(void **data, size_t n, SortKeyInt64Func key, void *ctx) {
+    if (key == NULL) {
+        return ERR_NIL;
+    }
+    RadixSortKey sort_key = {.i64 = key};
+    return radix_sort(data, n, RADIX_SORT_INT64, sort_key, ctx);
+}
+
+// Function to sort an array of pointers stably by a double key
+int radix_sort_ptr_double(void **data, size_t n, SortKeyDoubleFunc key, void *ctx) {
+    if (key == NULL) {
+        return ERR_NIL;
     }
-    
-    // Free the allocated stack memory
-    STL_FREE(stack);
+    RadixSortKey sort_key = {.d = key};
+    return radix_sort(data, n, RADIX_SORT_DOUBLE, sort_key, ctx);
 }
 
 // Function to perform binary search on a sorted array
-int binary_search(void *arr, size_t low, size_t high, void *data, SortGetFunc get, SortCmpFunc cmp) {
+size_t binary_search(void *arr, size_t low, size_t high, void *data, SortGetFunc get, SortCmpFunc cmp) {
     while (low <= high) {
         size_t mid = low + (high - low) / 2;
         void *current = NULL;
@@ -64,12 +1854,15 @@ int binary_search(void *arr, size_t low, size_t high, void *data, SortGetFunc ge
 
         int comparison = cmp(current, data);
         if (comparison == 0) {
-            return (int)mid;
+            return mid;
         } else if (comparison < 0) {
             low = mid + 1;
+        } else if (mid == low) {
+            // Nothing is left below mid, and mid - 1 would wrap around when mid is 0
+            return low;
         } else {
             high = mid - 1;
         }
     }
-    return (int)low;
+    return low;
 }
@@ -1,6 +1,7 @@
 #ifndef SORT_H
 #define SORT_H
 
+#include <stdint.h>
 #include <stdlib.h>
 
 // Function pointer type for getting data at a specific index in an array
@@ -15,10 +16,76 @@ typedef int (*SortSwapFunc)(void* arr, size_t i, size_t j);
 // Function pointer type for comparing two elements in an array
 typedef int (*SortCmpFunc)(const void* i, const void* j);
 
-// Function to perform quick sort on an array
+// Function pointer types for extracting a sort key from an element, as an unsigned or signed integer or a double
+typedef uint64_t (*SortKeyFunc)(void* ctx, const void* data);
+typedef int64_t (*SortKeyInt64Func)(void* ctx, const void* data);
+typedef double (*SortKeyDoubleFunc)(void* ctx, const void* data);
+
+// Function to perform quick sort on an array.
+// Introsort: median-of-three/ninther pivots, insertion sort for small partitions,
+// and a heapsort fallback when partitioning degrades; uses no heap memory.
 void quick_sort(void *arr, size_t low, size_t high, SortGetFunc get, SortSetFunc set, SortCmpFunc cmp, SortSwapFunc swap);
 
-// Function to perform binary search on a sorted array
-int binary_search(void *arr, size_t low, size_t high, void *data, SortGetFunc get, SortCmpFunc cmp);
+// Function to sort an array of pointers in place, calling only the comparator
+void quick_sort_ptr(void **data, size_t n, SortCmpFunc cmp);
+
+// Function to sort n elements of size bytes stored contiguously at data in place, calling only the comparator,
+// with pointers to the elements. The same introsort as quick_sort_ptr, moving whole elements by swapping them
+// a word at a time, so it needs no temporary element and no heap memory.
+void quick_sort_inline(void *data, size_t n, size_t size, SortCmpFunc cmp);
+
+// Functions to sort plain int32, uint64 and float keys in place, the typed fast path next to quick_sort_ptr.
+// On x86 CPUs with AVX2 they run a quicksort whose partitions are vectorized, down to blocks of at most 128
+// keys sorted by bitonic networks in registers; elsewhere they run typed_sort.h's scalar introsort.
+// Floats sort through an order-preserving mapping to int32: -0.0 sorts before 0.0, and NaNs sort after
+// +infinity (or before -infinity when their sign bit is set).
+void sort_int32(int32_t *data, size_t n);
+void sort_uint64(uint64_t *data, size_t n);
+void sort_float(float *data, size_t n);
+
+// Functions to sort the same keys with the scalar introsort only, the fallback of the functions above
+void sort_int32_scalar(int32_t *data, size_t n);
+void sort_uint64_scalar(uint64_t *data, size_t n);
+void sort_float_scalar(float *data, size_t n);
+
+// Function to reorder an array of pointers so that data[nth] is the element a full sort would put there,
+// with no element before it ordering after it and none after it ordering before it.
+// Introselect: quick_sort_ptr's partitioning recursing into the side holding nth only, expected O(n),
+// with a heapsort fallback that bounds the worst case by O(n log n).
+void nth_element_ptr(void **data, size_t n, size_t nth, SortCmpFunc cmp);
+
+// Function to move the k smallest pointers of an array, in sorted order, to its front; the rest are left
+// in an unspecified order. Selects with a bounded max-heap in O(n log k) when k is small next to n, and
+// with nth_element_ptr and a sort of the first k otherwise. Not stable.
+void partial_sort_ptr(void **data, size_t n, size_t k, SortCmpFunc cmp);
+
+// Function to copy the k smallest of n pointers, in sorted order, to out, which has room for k,
+// reading data once and leaving it unchanged. Keeps a max-heap of the best k seen so far in out,
+// O(n log k). Returns the number of pointers written, the smaller of k and n. Not stable.
+size_t top_k_ptr(void **data, size_t n, void **out, size_t k, SortCmpFunc cmp);
+
+// Function to sort an array of pointers stably, calling only the comparator.
+// TimSort: detects ascending and strictly descending runs, extends short ones with binary insertion
+// sort and merges them with galloping, so presorted input takes close to n comparisons.
+// Uses a temporary buffer of at most n / 2 pointers; returns ERR_OOM, leaving data in an
+// unspecified order, if it cannot be allocated.
+int tim_sort_ptr(void **data, size_t n, SortCmpFunc cmp);
+
+// Function to sort an array of pointers stably by an unsigned 64-bit key, calling key once per element.
+// LSD radix sort over (key, pointer) pairs, 11 bits per pass; passes over digits that are the same in
+// every key are skipped, so keys that fit in 32 bits take 3 passes instead of 6. Uses 32 bytes per element of
+// temporary memory and returns ERR_OOM, leaving data untouched, if it cannot be allocated.
+int radix_sort_ptr(void **data, size_t n, SortKeyFunc key, void *ctx);
+
+// Function to sort an array of pointers stably by a signed 64-bit key, like radix_sort_ptr
+int radix_sort_ptr_int64(void **data, size_t n, SortKeyInt64Func key, void *ctx);
+
+// Function to sort an array of pointers stably by a double key, like radix_sort_ptr.
+// -0.0 sorts before 0.0, and NaNs sort after +infinity (or before -infinity when their sign bit is set).
+int radix_sort_ptr_double(void **data, size_t n, SortKeyDoubleFunc key, void *ctx);
+
+// Function to perform binary search on the sorted range [low, high] of an array, high included.
+// Returns the index of an element equal to data, or the index data would be inserted at when there is none.
+size_t binary_search(void *arr, size_t low, size_t high, void *data, SortGetFunc get, SortCmpFunc cmp);
 
 #endif /*SORT_H*/
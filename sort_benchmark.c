@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "array.h"
+#include "sort.h"
+
+// Input patterns exercised by the benchmark
+typedef enum {
+    PATTERN_RANDOM,
+    PATTERN_SORTED,
+    PATTERN_REVERSED,
+    PATTERN_DUPLICATES,
+    PATTERN_RUNS,       // SORT_RUNS ascending runs concatenated
+    PATTERN_APPENDS,    // Sorted, then SORT_APPENDS random elements appended
+} Pattern;
+
+static const char *pattern_names[] = {"random", "sorted", "reversed", "duplicates", "16 runs", "sorted+32"};
+
+// Number of runs in PATTERN_RUNS and of random elements appended in PATTERN_APPENDS
+#define SORT_RUNS 16
+#define SORT_APPENDS 32
+
+// Number of comparator calls made through data_cmp_counted
+static size_t cmp_calls = 0;
+
+// Comparison function for sorting
+int data_cmp(void *i, void *j) {
+    int a = *(int*)i;
+    int b = *(int*)j;
+    return (a > b) - (a < b);
+}
+
+// Comparison function for sorting that also counts its calls
+int data_cmp_counted(void *i, void *j) {
+    cmp_calls++;
+    return data_cmp(i, j);
+}
+
+// Swap function for sorting
+int data_swap(void *arr, size_t i, size_t j) {
+    void *i_ptr = NULL;
+    void *j_ptr = NULL;
+
+    array_get_by_index(arr, i, &i_ptr);
+    array_get_by_index(arr, j, &j_ptr);
+    array_set_by_index(arr, i, j_ptr);
+    array_set_by_index(arr, j, i_ptr);
+    return OK;
+}
+
+// Function to destroy data during array destruction
+void data_destroy(void* ctx, void* data) {
+    STL_FREE(data);
+}
+
+// The Lomuto partition used by quick_sort before the introsort engine, kept for comparison
+static size_t legacy_partition(void *arr, size_t low, size_t high, SortGetFunc get, SortCmpFunc cmp, SortSwapFunc swap) {
+    void *pivot = NULL;
+    get(arr, high, &pivot);
+    size_t i = low;
+
+    for (size_t j = low; j < high; j++) {
+        void *current = NULL;
+        get(arr, j, &current);
+        if (cmp(current, pivot) < 0) {
+            if (i != j) {
+                swap(arr, i, j);
+            }
+            i++;
+        }
+    }
+
+    if (i != high) {
+        swap(arr, i, high);
+    }
+    return i;
+}
+
+// The quick_sort used before the introsort engine, kept for comparison
+static void legacy_quick_sort(void *arr, size_t low, size_t high, SortGetFunc get, SortCmpFunc cmp, SortSwapFunc swap) {
+    size_t* stack = (size_t*)STL_MALLOC((high - low + 1) * sizeof(size_t));
+    int top = -1;
+
+    stack[++top] = low;
+    stack[++top] = high;
+
+    while (top >= 0) {
+        high = stack[top--];
+        low = stack[top--];
+
+        size_t mid = legacy_partition(arr, low, high, get, cmp, swap);
+        if (mid > low) {
+            stack[++top] = low;
+            stack[++top] = mid - 1;
+        }
+
+        if (mid < high) {
+            stack[++top] = mid + 1;
+            stack[++top] = high;
+        }
+    }
+    STL_FREE(stack);
+}
+
+// Function to build an array of n integers following a pattern
+static Array *make_array(Pattern pattern, size_t n) {
+    Array *array = array_create(data_destroy, NULL);
+    for (size_t i = 0; i < n; i++) {
+        int *value = (int*) STL_MALLOC(sizeof(int));
+        switch (pattern) {
+            case PATTERN_RANDOM:     *value = rand(); break;
+            case PATTERN_SORTED:     *value = (int)i; break;
+            case PATTERN_REVERSED:   *value = (int)(n - i); break;
+            case PATTERN_DUPLICATES: *value = rand() % 16; break;
+            case PATTERN_RUNS:       *value = (int)((i % (n / SORT_RUNS + 1)) * SORT_RUNS) + rand() % SORT_RUNS; break;
+            case PATTERN_APPENDS:    *value = i + SORT_APPENDS < n ? (int)i : rand(); break;
+        }
+        array_append(array, value);
+    }
+    return array;
+}
+
+// Function to check that an array is in ascending order
+static BOOL is_sorted(Array *array) {
+    for (size_t i = 1; i < array_length(array); i++) {
+        if (data_cmp(array->data[i - 1], array->data[i]) > 0) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Function to get the current monotonic time in milliseconds
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// Function to time one sort of a freshly generated array
+static double bench(Pattern pattern, size_t n, BOOL legacy) {
+    Array *array = make_array(pattern, n);
+    double start = now_ms();
+    if (legacy) {
+        legacy_quick_sort(array, 0, n - 1, (SortGetFunc)array_get_by_index, (SortCmpFunc)data_cmp, data_swap);
+    } else {
+        quick_sort(array, 0, n - 1, (SortGetFunc)array_get_by_index, (SortSetFunc)array_set_by_index,
+                   (SortCmpFunc)data_cmp, data_swap);
+    }
+    double elapsed = now_ms() - start;
+
+    if (!is_sorted(array)) {
+        printf("%s: output is not sorted\n", pattern_names[pattern]);
+    }
+    array_destroy(array);
+    return elapsed;
+}
+
+// Function to time the callback-driven quick_sort against the direct array_sort path
+static void bench_array_sort(Pattern pattern, size_t n) {
+    Array *array = make_array(pattern, n);
+    double start = now_ms();
+    quick_sort(array, 0, n - 1, (SortGetFunc)array_get_by_index, (SortSetFunc)array_set_by_index,
+               (SortCmpFunc)data_cmp, data_swap);
+    double callbacks = now_ms() - start;
+    array_destroy(array);
+
+    srand(42);
+    array = make_array(pattern, n);
+    start = now_ms();
+    array_sort(array, data_cmp, NULL);
+    double direct = now_ms() - start;
+
+    if (!is_sorted(array)) {
+        printf("%s: output is not sorted\n", pattern_names[pattern]);
+    }
+    array_destroy(array);
+    printf("%-12s %12.2f %12.2f %11.1fx\n", pattern_names[pattern], callbacks, direct, callbacks / direct);
+}
+
+// Function to time array_sort against array_sort_stable, with the comparisons each makes per element
+static void bench_stable(Pattern pattern, size_t n) {
+    double ms[2];
+    double cmps[2];
+
+    for (int stable = 0; stable < 2; stable++) {
+        srand(42);
+        Array *array = make_array(pattern, n);
+        cmp_calls = 0;
+        double start = now_ms();
+        if (stable) {
+            array_sort_stable(array, data_cmp_counted);
+        } else {
+            array_sort(array, data_cmp_counted, NULL);
+        }
+        ms[stable] = now_ms() - start;
+        cmps[stable] = (double)cmp_calls / (double)n;
+        if (!is_sorted(array)) {
+            printf("%s: output is not sorted\n", pattern_names[pattern]);
+        }
+        array_destroy(array);
+    }
+    printf("%-12s %12.2f %10.2f %12.2f %10.2f\n", pattern_names[pattern], ms[0], cmps[0], ms[1], cmps[1]);
+}
+
+int main(int argc, char *argv[]) {
+    // The legacy sort is quadratic on sorted input, so keep the default size modest
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    size_t large_n = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+    srand(42);
+
+    printf("%-12s %12s %12s %12s\n", "pattern", "legacy(ms)", "introsort(ms)", "speedup");
+    for (int p = PATTERN_RANDOM; p <= PATTERN_DUPLICATES; p++) {
+        double legacy = bench((Pattern)p, n, TRUE);
+        double intro = bench((Pattern)p, n, FALSE);
+        printf("%-12s %12.2f %12.2f %11.1fx\n", pattern_names[p], legacy, intro, legacy / intro);
+    }
+
+    printf("\n%zu elements\n", large_n);
+    printf("%-12s %12s %12s %12s\n", "pattern", "callbacks(ms)", "array_sort(ms)", "speedup");
+    for (int p = PATTERN_RANDOM; p <= PATTERN_DUPLICATES; p++) {
+        srand(42);
+        bench_array_sort((Pattern)p, large_n);
+    }
+
+    printf("\n%zu elements, array_sort vs array_sort_stable\n", large_n);
+    printf("%-12s %12s %10s %12s %10s\n", "pattern", "sort(ms)", "cmp/elem", "stable(ms)", "cmp/elem");
+    for (int p = PATTERN_RANDOM; p <= PATTERN_APPENDS; p++) {
+        bench_stable((Pattern)p, large_n);
+    }
+    return 0;
+}
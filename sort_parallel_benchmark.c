@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "array_parallel.h"
+
+// Comparison function for sorting
+int data_cmp(void *i, void *j) {
+    int a = *(int*)i;
+    int b = *(int*)j;
+    return (a > b) - (a < b);
+}
+
+// Function to get the current monotonic time in milliseconds
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// Function to check that an array is in ascending order
+static BOOL is_sorted(Array *array) {
+    for (size_t i = 1; i < array_length(array); i++) {
+        if (data_cmp(array->data[i - 1], array->data[i]) > 0) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Function to time one sort of a copy of the unsorted elements; threads of 0 times array_sort
+static double bench(Array *array, void **unsorted, size_t threads) {
+    memcpy(array->data, unsorted, array_length(array) * sizeof(void*));
+    Scheduler *scheduler = threads > 0 ? scheduler_create(threads) : NULL;
+
+    double start = now_ms();
+    if (scheduler == NULL) {
+        array_sort(array, data_cmp, NULL);
+    } else {
+        array_sort_parallel(scheduler, array, data_cmp, 0);
+    }
+    double elapsed = now_ms() - start;
+
+    if (!is_sorted(array)) {
+        printf("%zu threads: output is not sorted\n", threads);
+    }
+    scheduler_destroy(scheduler);
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : 16;
+    int *values = (int*)malloc(n * sizeof(int));
+    void **unsorted = (void**)malloc(n * sizeof(void*));
+    Array *array = array_create(NULL, NULL);
+
+    srand(42);
+    for (size_t i = 0; i < n; i++) {
+        values[i] = rand();
+        unsorted[i] = &values[i];
+        array_append(array, unsorted[i]);
+    }
+
+    double serial = bench(array, unsorted, 0);
+    printf("%zu random elements\n", n);
+    printf("%-12s %12s %10s\n", "threads", "ms", "speedup");
+    printf("%-12s %12.1f %10s\n", "array_sort", serial, "-");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double elapsed = bench(array, unsorted, threads);
+        printf("%-12zu %12.1f %9.2fx\n", threads, elapsed, serial / elapsed);
+    }
+
+    array_destroy(array);
+    free(unsorted);
+    free(values);
+    return 0;
+}
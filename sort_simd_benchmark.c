@@ -0,0 +1,96 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sort.h"
+#include "typedef.h"
+
+// Each size is sorted often enough to cover this many keys, each run on different keys so that small sizes
+// are not timed on input the branch predictor has learned
+#define BENCH_KEYS 10000000
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to get a random 64-bit value
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = (*state += 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Structure representing one key type: its size and its sorts, behind untyped wrappers
+typedef struct {
+    const char *name;
+    size_t key_size;
+    void (*scalar)(void *keys, size_t n);
+    void (*simd)(void *keys, size_t n);
+} KeyType;
+
+// Wrappers giving the typed sorts a common signature
+static void int32_scalar(void *keys, size_t n) { sort_int32_scalar((int32_t *)keys, n); }
+static void int32_simd(void *keys, size_t n) { sort_int32((int32_t *)keys, n); }
+static void uint64_scalar(void *keys, size_t n) { sort_uint64_scalar((uint64_t *)keys, n); }
+static void uint64_simd(void *keys, size_t n) { sort_uint64((uint64_t *)keys, n); }
+static void float_scalar(void *keys, size_t n) { sort_float_scalar((float *)keys, n); }
+static void float_simd(void *keys, size_t n) { sort_float((float *)keys, n); }
+
+// Function to time one of the typed sorts in nanoseconds per key, sorting consecutive chunks of n keys of source
+static double bench(void (*sort)(void *, size_t), void *keys, const char *source, size_t n, size_t key_size) {
+    size_t runs = n < BENCH_KEYS ? BENCH_KEYS / n : 1;
+    double elapsed = 0;
+    for (size_t r = 0; r < runs; r++) {
+        memcpy(keys, source + r * n * key_size, n * key_size);
+        double start = now_ns();
+        sort(keys, n);
+        elapsed += now_ns() - start;
+    }
+    return elapsed / (double)(runs * n);
+}
+
+int main(int argc, char *argv[]) {
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000000;
+    KeyType types[] = {
+        {"int32", sizeof(int32_t), int32_scalar, int32_simd},
+        {"uint64", sizeof(uint64_t), uint64_scalar, uint64_simd},
+        {"float", sizeof(float), float_scalar, float_simd},
+    };
+    size_t source_n = max_n > BENCH_KEYS ? max_n : BENCH_KEYS;
+    uint64_t *source = (uint64_t *)malloc(source_n * sizeof(uint64_t));
+    uint64_t *fast_keys = (uint64_t *)malloc(max_n * sizeof(uint64_t));
+    uint64_t *scalar_keys = (uint64_t *)malloc(max_n * sizeof(uint64_t));
+
+    printf("random keys, ns per key (sizes below %d averaged over that many keys)\n", BENCH_KEYS);
+    printf("%-8s %11s %10s %10s %9s %7s\n", "type", "n", "scalar", "simd", "speedup", "check");
+    for (int t = 0; t < 3; t++) {
+        for (size_t n = 1000; n <= max_n; n *= 10) {
+            uint64_t state = 42;
+            for (size_t i = 0; i < (n > BENCH_KEYS ? n : BENCH_KEYS); i++) {
+                uint64_t r = next_random(&state);
+                if (t == 0) {
+                    ((int32_t *)source)[i] = (int32_t)r;
+                } else if (t == 1) {
+                    source[i] = r;
+                } else {
+                    ((float *)source)[i] = (float)((double)(int64_t)r / 1e12);
+                }
+            }
+            double scalar_ns = bench(types[t].scalar, scalar_keys, (const char *)source, n, types[t].key_size);
+            double fast_ns = bench(types[t].simd, fast_keys, (const char *)source, n, types[t].key_size);
+            BOOL ok = memcmp(fast_keys, scalar_keys, n * types[t].key_size) == 0;
+            printf("%-8s %11zu %10.2f %10.2f %8.1fx %7s\n", types[t].name, n, scalar_ns, fast_ns, scalar_ns / fast_ns,
+                   ok ? "ok" : "MISMATCH");
+        }
+    }
+
+    free(scalar_keys);
+    free(fast_keys);
+    free(source);
+    return 0;
+}
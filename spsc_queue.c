@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <string.h>
+#include "spsc_queue.h"
+
+// Function to create a queue holding up to capacity elements
+SpscQueue* spsc_queue_create(size_t capacity, DataDestroyFunc data_destroy, void* ctx) {
+    // Neither rounding capacity up to a power of two nor sizing the slots may overflow
+    return_val_if_fail(capacity <= SIZE_MAX / 2 + 1, NULL);
+    size_t slots = 2;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    return_val_if_fail(slots <= SIZE_MAX / sizeof(void*), NULL);
+
+    // Over-allocate by one cache line and align the queue inside the block
+    void* mem = STL_MALLOC(sizeof(SpscQueue) + SPSC_QUEUE_CACHE_LINE);
+    if (mem == NULL) {
+        return NULL;
+    }
+    SpscQueue* self = (SpscQueue*)(((uintptr_t)mem + SPSC_QUEUE_CACHE_LINE - 1)
+                                   & ~(uintptr_t)(SPSC_QUEUE_CACHE_LINE - 1));
+    if ((self->data = (void**)STL_MALLOC(slots * sizeof(void*))) == NULL) {
+        STL_FREE(mem);
+        return NULL;
+    }
+    atomic_init(&self->head, 0);
+    atomic_init(&self->tail, 0);
+    self->cached_head = 0;
+    self->cached_tail = 0;
+    self->capacity = slots;
+    self->data_destroy = data_destroy;
+    self->data_destroy_ctx = ctx;
+    self->mem = mem;
+    return self;
+}
+
+// Function to get how many slots the producer can fill, reloading the consumer's head only when needed
+static inline size_t spsc_queue_free(SpscQueue* self, size_t tail, size_t want) {
+    size_t free = self->capacity - (tail - self->cached_head);
+    if (free < want) {
+        self->cached_head = atomic_load_explicit(&self->head, memory_order_acquire);
+        free = self->capacity - (tail - self->cached_head);
+    }
+    return free;
+}
+
+// Function to get how many elements the consumer can take, reloading the producer's tail only when needed
+static inline size_t spsc_queue_ready(SpscQueue* self, size_t head, size_t want) {
+    size_t ready = self->cached_tail - head;
+    if (ready < want) {
+        self->cached_tail = atomic_load_explicit(&self->tail, memory_order_acquire);
+        ready = self->cached_tail - head;
+    }
+    return ready;
+}
+
+// Function to push an element from the producer thread
+int spsc_queue_push(SpscQueue* self, void* data) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+
+    if (spsc_queue_free(self, tail, 1) == 0) {
+        return ERR_FULL;
+    }
+    self->data[tail & (self->capacity - 1)] = data;
+    // Release publishes the slot contents before the consumer can observe the new tail
+    atomic_store_explicit(&self->tail, tail + 1, memory_order_release);
+    return OK;
+}
+
+// Function to push up to n elements from the producer thread with a single tail update
+size_t spsc_queue_push_n(SpscQueue* self, void** data, size_t n) {
+    return_val_if_fail(self != NULL && (data != NULL || n == 0), 0);
+    size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+    size_t free = spsc_queue_free(self, tail, n);
+
+    n = n < free ? n : free;
+    if (n == 0) {
+        return 0;
+    }
+
+    // Copy up to the end of the buffer, then wrap to its start
+    size_t pos = tail & (self->capacity - 1);
+    size_t first = self->capacity - pos;
+    first = first < n ? first : n;
+    memcpy(self->data + pos, data, first * sizeof(void*));
+    memcpy(self->data, data + first, (n - first) * sizeof(void*));
+    atomic_store_explicit(&self->tail, tail + n, memory_order_release);
+    return n;
+}
+
+// Function to pop the element at the head from the consumer thread
+int spsc_queue_pop(SpscQueue* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+
+    if (spsc_queue_ready(self, head, 1) == 0) {
+        return ERR_NIL;
+    }
+    *data = self->data[head & (self->capacity - 1)];
+    // Release keeps the read of the slot before the producer can reuse it
+    atomic_store_explicit(&self->head, head + 1, memory_order_release);
+    return OK;
+}
+
+// Function to pop up to n elements from the consumer thread with a single head update
+size_t spsc_queue_pop_n(SpscQueue* self, void** data, size_t n) {
+    return_val_if_fail(self != NULL && (data != NULL || n == 0), 0);
+    size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+    size_t ready = spsc_queue_ready(self, head, n);
+
+    n = n < ready ? n : ready;
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t pos = head & (self->capacity - 1);
+    size_t first = self->capacity - pos;
+    first = first < n ? first : n;
+    memcpy(data, self->data + pos, first * sizeof(void*));
+    memcpy(data + first, self->data, (n - first) * sizeof(void*));
+    atomic_store_explicit(&self->head, head + n, memory_order_release);
+    return n;
+}
+
+// Function to get the number of elements in the queue
+size_t spsc_queue_length(SpscQueue* self) {
+    return_val_if_fail(self != NULL, 0);
+    size_t head = atomic_load_explicit(&self->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&self->tail, memory_order_acquire);
+    // Reading head first keeps tail - head from going negative; a stale head can only overstate it
+    size_t size = tail - head;
+    return size < self->capacity ? size : self->capacity;
+}
+
+// Function to destroy the queue and the elements left in it
+void spsc_queue_destroy(SpscQueue* self) {
+    if (self != NULL) {
+        size_t head = atomic_load_explicit(&self->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+        if (self->data_destroy != NULL) {
+            for (; head != tail; head++) {
+                self->data_destroy(self->data_destroy_ctx, self->data[head & (self->capacity - 1)]);
+            }
+        }
+        void* mem = self->mem;
+        STL_FREE(self->data);
+        STL_FREE(mem);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include "typedef.h"
+
+#define SPSC_QUEUE_CACHE_LINE 64
+
+// Structure representing a bounded single-producer/single-consumer ring queue.
+// Exactly one thread may push and one other thread may pop; neither takes a lock.
+// The producer's and the consumer's fields sit on separate cache lines, and each side
+// keeps a cached copy of the other's index so it only reads the shared one when the
+// queue looks full (producer) or empty (consumer).
+typedef struct {
+    // Written by the consumer
+    _Alignas(SPSC_QUEUE_CACHE_LINE) atomic_size_t head;    // Next position to pop
+    size_t cached_tail;                                     // Consumer's last view of tail
+
+    // Written by the producer
+    _Alignas(SPSC_QUEUE_CACHE_LINE) atomic_size_t tail;    // Next position to push
+    size_t cached_head;                                     // Producer's last view of head
+
+    // Read-only after creation
+    _Alignas(SPSC_QUEUE_CACHE_LINE) void** data;           // Ring buffer of capacity slots
+    size_t capacity;                                        // Number of slots, a power of two
+    DataDestroyFunc data_destroy;                           // Function to destroy elements left at destruction
+    void* data_destroy_ctx;                                 // Context for data destruction
+    void* mem;                                              // Allocation the aligned queue lives in
+} SpscQueue;
+
+// Function to create a queue holding up to capacity elements (rounded up to a power of two)
+SpscQueue* spsc_queue_create(size_t capacity, DataDestroyFunc data_destroy, void* ctx);
+
+// Function to push an element, called by the producer thread only. Returns ERR_FULL when the queue is full.
+int spsc_queue_push(SpscQueue* self, void* data);
+
+// Function to push up to n elements in order, publishing them to the consumer at once.
+// Called by the producer thread only, returns how many were pushed.
+size_t spsc_queue_push_n(SpscQueue* self, void** data, size_t n);
+
+// Function to pop the element at the head, called by the consumer thread only. Returns ERR_NIL when empty.
+int spsc_queue_pop(SpscQueue* self, void** data);
+
+// Function to pop up to n elements into data, releasing their slots to the producer at once.
+// Called by the consumer thread only, returns how many were popped.
+size_t spsc_queue_pop_n(SpscQueue* self, void** data, size_t n);
+
+// Function to get the number of elements in the queue, a snapshot while the other thread runs
+size_t spsc_queue_length(SpscQueue* self);
+
+// Function to destroy the queue and the elements left in it, once both threads are done with it
+void spsc_queue_destroy(SpscQueue* self);
+
+#endif /*SPSC_QUEUE_H*/
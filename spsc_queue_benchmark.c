@@ -0,0 +1,206 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "queue.h"
+#include "spsc_queue.h"
+
+// Number of elements moved per spsc_queue_push_n/spsc_queue_pop_n call
+#define BATCH 64
+
+// Structure representing the work of one benchmark thread
+typedef struct {
+    SpscQueue *in;          // Queue the thread pops from, NULL for a pure producer
+    SpscQueue *out;         // Queue the thread pushes to, NULL for a pure consumer
+    Queue *locked;          // Mutex-guarded queue used instead of in/out when set
+    pthread_mutex_t *lock;
+    size_t n;               // Number of elements to move
+    BOOL batched;
+    int cpu;                // CPU to pin the thread to
+    size_t errors;          // Elements the consumer received out of order
+} Worker;
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Whether both threads could be pinned to distinct CPUs
+static BOOL pinned = TRUE;
+
+// Function to pin the calling thread to a CPU, falling back to unpinned when the CPU does not exist
+static void pin(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        pinned = FALSE;
+    }
+}
+
+// Function to wait briefly while the other side catches up; yields so one CPU can still run both threads
+static inline void backoff(unsigned *spins) {
+    if (++*spins > 64) {
+        sched_yield();
+        *spins = 0;
+    }
+}
+
+// Function to pop an element, spinning until one arrives
+static inline void *pop_wait(SpscQueue *queue) {
+    void *data = NULL;
+    unsigned spins = 0;
+    while (spsc_queue_pop(queue, &data) != OK) {
+        backoff(&spins);
+    }
+    return data;
+}
+
+// Function to push an element, spinning while the queue is full
+static inline void push_wait(SpscQueue *queue, void *data) {
+    unsigned spins = 0;
+    while (spsc_queue_push(queue, data) != OK) {
+        backoff(&spins);
+    }
+}
+
+// Function to echo every element it receives back to the sender
+static void *echo_run(void *arg) {
+    Worker *worker = (Worker *)arg;
+    pin(worker->cpu);
+    for (size_t i = 0; i < worker->n; i++) {
+        push_wait(worker->out, pop_wait(worker->in));
+    }
+    return NULL;
+}
+
+// Function to produce n elements into the queue, one by one or in batches
+static void *producer_run(void *arg) {
+    Worker *worker = (Worker *)arg;
+    void *batch[BATCH];
+    unsigned spins = 0;
+    pin(worker->cpu);
+
+    for (size_t i = 0; i < worker->n;) {
+        if (worker->locked != NULL) {
+            pthread_mutex_lock(worker->lock);
+            queue_push(worker->locked, (void *)(i + 1));
+            pthread_mutex_unlock(worker->lock);
+            i++;
+        } else if (worker->batched) {
+            size_t count = worker->n - i < BATCH ? worker->n - i : BATCH;
+            for (size_t j = 0; j < count; j++) {
+                batch[j] = (void *)(i + j + 1);
+            }
+            size_t pushed = 0;
+            while (pushed < count) {
+                size_t k = spsc_queue_push_n(worker->out, batch + pushed, count - pushed);
+                if (k == 0) {
+                    backoff(&spins);
+                }
+                pushed += k;
+            }
+            i += count;
+        } else {
+            push_wait(worker->out, (void *)(i + 1));
+            i++;
+        }
+    }
+    return NULL;
+}
+
+// Function to consume n elements from the queue, counting the ones that arrive out of order
+static void *consumer_run(void *arg) {
+    Worker *worker = (Worker *)arg;
+    void *batch[BATCH];
+    size_t received = 0;
+    unsigned spins = 0;
+    pin(worker->cpu);
+
+    while (received < worker->n) {
+        size_t k = 1;
+        if (worker->locked != NULL) {
+            pthread_mutex_lock(worker->lock);
+            k = queue_pop_n(worker->locked, batch, 1);
+            pthread_mutex_unlock(worker->lock);
+        } else if (worker->batched) {
+            k = spsc_queue_pop_n(worker->in, batch, BATCH);
+        } else {
+            batch[0] = pop_wait(worker->in);
+        }
+        if (k == 0) {
+            backoff(&spins);
+        }
+        for (size_t j = 0; j < k; j++) {
+            worker->errors += (size_t)batch[j] != ++received;
+        }
+    }
+    return NULL;
+}
+
+// Function to measure the round trip of one element between two threads, in nanoseconds
+static double bench_ping_pong(size_t n) {
+    SpscQueue *ping = spsc_queue_create(64, NULL, NULL);
+    SpscQueue *pong = spsc_queue_create(64, NULL, NULL);
+    Worker echo = {ping, pong, NULL, NULL, n, FALSE, 1, 0};
+    pthread_t thread;
+
+    pin(0);
+    pthread_create(&thread, NULL, echo_run, &echo);
+    double start = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        push_wait(ping, (void *)(i + 1));
+        pop_wait(pong);
+    }
+    double ns = (now_ns() - start) / (double)n;
+    pthread_join(thread, NULL);
+
+    spsc_queue_destroy(ping);
+    spsc_queue_destroy(pong);
+    return ns;
+}
+
+// Function to measure producer to consumer throughput, in million elements per second
+static double bench_throughput(size_t n, int mode) {
+    SpscQueue *queue = spsc_queue_create(4096, NULL, NULL);
+    Queue *locked = mode == 0 ? queue_create(NULL, NULL) : NULL;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    Worker producer = {NULL, queue, locked, &lock, n, mode == 2, 0, 0};
+    Worker consumer = {queue, NULL, locked, &lock, n, mode == 2, 1, 0};
+    pthread_t threads[2];
+
+    double start = now_ns();
+    pthread_create(&threads[0], NULL, producer_run, &producer);
+    pthread_create(&threads[1], NULL, consumer_run, &consumer);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    double mops = (double)n / (now_ns() - start) * 1e3;
+    if (consumer.errors != 0) {
+        printf("MISMATCH: %zu elements out of order\n", consumer.errors);
+    }
+
+    queue_destroy(locked);
+    spsc_queue_destroy(queue);
+    return mops;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    const char *modes[3] = {"mutex+Queue", "spsc", "spsc batch"};
+
+    double rtt = bench_ping_pong(n / 100);
+    printf("ping-pong round trip: %.1f ns\n", rtt);
+
+    printf("\n%zu elements, producer -> consumer (Melem/s)\n", n);
+    for (int mode = 0; mode < 3; mode++) {
+        printf("%-12s %10.2f\n", modes[mode], bench_throughput(n, mode));
+    }
+    if (!pinned) {
+        printf("\nwarning: threads could not be pinned to distinct CPUs, results include scheduler effects\n");
+    }
+    return 0;
+}
@@ -1,53 +1,119 @@
+#include <stdint.h>
 #include "stack.h"
-#include "list.h"
 #include "typedef.h"
 
+#define MIN_SIZE 16
+
 // Function to create a new stack
 Stack* stack_create(DataDestroyFunc data_destroy, void* ctx) {
     Stack* self = (Stack*)STL_MALLOC(sizeof(Stack));
     if (self != NULL) {
-        if ((self->list = list_create(data_destroy, ctx)) == NULL) {
+        if ((self->data = (void**)STL_MALLOC(MIN_SIZE * sizeof(void*))) == NULL) {
             STL_FREE(self);
+            self = NULL;
+        } else {
+            self->size = 0;
+            self->alloc_size = MIN_SIZE;
+            self->data_destroy = data_destroy;
+            self->data_destroy_ctx = ctx;
         }
     }
     return self;
 }
 
+// Function to make room for at least n elements in total
+int stack_reserve(Stack* self, size_t n) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    size_t alloc_size = self->alloc_size;
+    if (n <= alloc_size) {
+        return OK;
+    }
+    // Neither the byte size nor the doubling below may overflow
+    if (n > SIZE_MAX / sizeof(void*)) {
+        return ERR_OOM;
+    }
+    while (n > alloc_size) {
+        if (alloc_size > SIZE_MAX / sizeof(void*) / 2) {
+            return ERR_OOM;
+        }
+        alloc_size <<= 1;
+    }
+    void** data = (void**)realloc(self->data, alloc_size * sizeof(void*));
+    if (data == NULL) {
+        return ERR_OOM;
+    }
+    self->data = data;
+    self->alloc_size = alloc_size;
+    return OK;
+}
+
 // Function to get the element at the top of the stack without removing it
 int stack_top(Stack* self, void** data) {
     return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
-    return list_get_by_index(self->list, 0, data);
+    if (self->size == 0) {
+        return ERR_NIL;
+    }
+    *data = self->data[self->size - 1];
+    return OK;
 }
 
 // Function to push an element onto the stack
 int stack_push(Stack* self, void* data) {
     return_val_if_fail(self != NULL, ERR_NIL);
-    return list_prepend(self->list, data);
+    if (self->size == self->alloc_size && stack_reserve(self, self->size + 1) != OK) {
+        return ERR_OOM;
+    }
+    self->data[self->size++] = data;
+    return OK;
+}
+
+// Function to pop the top element into data without destroying it
+int stack_pop_into(Stack* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    if (self->size == 0) {
+        return ERR_NIL;
+    }
+    // The buffer keeps its size, so stacks that grow and drain repeatedly never reallocate
+    *data = self->data[--self->size];
+    return OK;
 }
 
 // Function to pop the top element from the stack
 int stack_pop(Stack* self) {
-    return_val_if_fail(self != NULL, ERR_NIL);
-    return list_delete(self->list, 0);
+    void* data = NULL;
+    int ret = stack_pop_into(self, &data);
+    if (ret == OK && self->data_destroy != NULL) {
+        self->data_destroy(self->data_destroy_ctx, data);
+    }
+    return ret;
 }
 
 // Function to get the current length (number of elements) in the stack
 size_t stack_length(Stack* self) {
     return_val_if_fail(self != NULL, 0);
-    return list_length(self->list);
+    return self->size;
 }
 
-// Function to apply a visit function to each element in the stack
+// Function to apply a visit function to each element in the stack, from the top down
 int stack_foreach(Stack* self, DataVisitFunc visit, void* ctx) {
     return_val_if_fail(self != NULL && visit != NULL, ERR_NIL);
-    return list_foreach(self->list, visit, ctx);
+    for (size_t i = 0; i < self->size; i++) {
+        if (!visit(ctx, i, self->data[self->size - 1 - i])) {
+            break;
+        }
+    }
+    return OK;
 }
 
 // Function to destroy the stack
 void stack_destroy(Stack* self) {
     if (self != NULL) {
-        list_destroy(self->list);
-        self->list = NULL;
+        if (self->data_destroy != NULL) {
+            for (size_t i = self->size; i > 0; i--) {
+                self->data_destroy(self->data_destroy_ctx, self->data[i - 1]);
+            }
+        }
+        STL_FREE(self->data);
         STL_FREE(self);
     }
     return;
@@ -1,12 +1,16 @@
 #ifndef STACK_H
 #define STACK_H
 
+#include <stdio.h>
 #include "typedef.h"
-#include "list.h"
 
-// Structure representing a stack
+// Structure representing a stack, a growable contiguous buffer whose end is the top
 typedef struct {
-    List* list; // Underlying list to store stack elements
+    void** data;                    // Elements, bottom first
+    size_t size;                    // Number of elements in the stack
+    size_t alloc_size;              // Number of slots in data
+    DataDestroyFunc data_destroy;   // Function to destroy elements popped or left at destruction
+    void* data_destroy_ctx;         // Context for data destruction
 } Stack;
 
 // Function to create a new stack
@@ -21,10 +25,16 @@ int stack_push(Stack* thiz, void* data);
 // Function to pop the top element from the stack
 int stack_pop(Stack* thiz);
 
+// Function to pop the top element into data; ownership passes to the caller, it is not destroyed
+int stack_pop_into(Stack* thiz, void** data);
+
+// Function to make room for at least n elements in total, so pushes up to n never reallocate
+int stack_reserve(Stack* thiz, size_t n);
+
 // Function to get the current length (number of elements) in the stack
 size_t stack_length(Stack* thiz);
 
-// Function to apply a visit function to each element in the stack
+// Function to apply a visit function to each element in the stack, from the top down
 int stack_foreach(Stack* thiz, DataVisitFunc visit, void* ctx);
 
 // Function to destroy the stack
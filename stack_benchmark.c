@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "list.h"
+#include "stack.h"
+
+// Function to get the current monotonic time in nanoseconds
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Function to run a DFS-like pattern on a list-backed stack, as stack.c did before the contiguous buffer:
+// push depth elements, pop them, and repeat until ops pushes are done
+static double bench_list(size_t ops, size_t depth) {
+    List *list = list_create(NULL, NULL);
+    size_t sum = 0;
+    double start = now_ns();
+    for (size_t done = 0; done < ops; done += depth) {
+        for (size_t i = 0; i < depth; i++) {
+            list_prepend(list, (void*)(i + 1));
+        }
+        for (size_t i = 0; i < depth; i++) {
+            void *data = NULL;
+            list_get_by_index(list, 0, &data);
+            sum += (size_t)data;
+            list_delete(list, 0);
+        }
+    }
+    double ns = (now_ns() - start) / (double)ops;
+    list_destroy(list);
+    return sum != 0 ? ns : 0;
+}
+
+// Function to run the same pattern on the contiguous stack with stack_top + stack_pop or stack_pop_into
+static double bench_stack(size_t ops, size_t depth, BOOL pop_into) {
+    Stack *stack = stack_create(NULL, NULL);
+    size_t sum = 0;
+    double start = now_ns();
+    for (size_t done = 0; done < ops; done += depth) {
+        for (size_t i = 0; i < depth; i++) {
+            stack_push(stack, (void*)(i + 1));
+        }
+        for (size_t i = 0; i < depth; i++) {
+            void *data = NULL;
+            if (pop_into) {
+                stack_pop_into(stack, &data);
+            } else {
+                stack_top(stack, &data);
+                stack_pop(stack);
+            }
+            sum += (size_t)data;
+        }
+    }
+    double ns = (now_ns() - start) / (double)ops;
+    stack_destroy(stack);
+    return sum != 0 ? ns : 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000000;
+    size_t depths[] = {16, 1024, 1000000};
+
+    printf("%zu push/pop pairs, ns per pair\n", ops);
+    printf("%-10s %12s %12s %14s\n", "depth", "list", "stack", "stack_pop_into");
+    for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+        printf("%-10zu %12.2f %12.2f %14.2f\n", depths[i], bench_list(ops, depths[i]),
+               bench_stack(ops, depths[i], FALSE), bench_stack(ops, depths[i], TRUE));
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#ifndef TYPED_ARRAY_H
+#define TYPED_ARRAY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "typedef.h"
+
+// Compile-time specialized dynamic array storing T by value.
+//
+// CSTL_ARRAY_DECLARE(name, T) generates a struct `name` and the functions
+//     name* name_create(void);
+//     int   name_reserve(name* self, size_t n);
+//     int   name_insert(name* self, size_t index, T value);
+//     int   name_append(name* self, T value);
+//     int   name_delete(name* self, size_t index);
+//     T*    name_at(name* self, size_t index);
+//     size_t name_length(name* self);
+//     void  name_destroy(name* self);
+// Elements live contiguously in `data`, so scans are sequential and the
+// per-element STL_MALLOC of the generic Array is not needed. The generic
+// Array in array.h corresponds to the void* instance of this layout.
+// Use CSTL_SORT_DECLARE from typed_sort.h to sort `data`.
+
+#define CSTL_ARRAY_MIN_SIZE 16
+
+#define CSTL_ARRAY_DECLARE(name, T)                                                 \
+                                                                                    \
+typedef struct {                                                                    \
+    T *data;                                                                        \
+    size_t size;                                                                    \
+    size_t alloc_size;                                                              \
+} name;                                                                             \
+                                                                                    \
+static inline name *name##_create(void) {                                           \
+    name *self = (name *)STL_MALLOC(sizeof(name));                                  \
+    if (self != NULL) {                                                             \
+        self->data = (T *)STL_MALLOC(CSTL_ARRAY_MIN_SIZE * sizeof(T));              \
+        if (self->data == NULL) {                                                   \
+            STL_FREE(self);                                                         \
+            return NULL;                                                            \
+        }                                                                           \
+        self->size = 0;                                                             \
+        self->alloc_size = CSTL_ARRAY_MIN_SIZE;                                     \
+    }                                                                               \
+    return self;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline int name##_reserve(name *self, size_t n) {                            \
+    return_val_if_fail(self != NULL, ERR_NIL);                                      \
+    size_t alloc_size = self->alloc_size;                                           \
+    if (n <= alloc_size) {                                                          \
+        return OK;                                                                  \
+    }                                                                               \
+    while (n > alloc_size) {                                                        \
+        if (alloc_size == 0) {                                                      \
+            alloc_size = CSTL_ARRAY_MIN_SIZE;                                       \
+        } else if (alloc_size < 1024) {                                             \
+            alloc_size = alloc_size << 1;                                           \
+        } else {                                                                    \
+            alloc_size = alloc_size + (alloc_size >> 3);                            \
+        }                                                                           \
+    }                                                                               \
+    T *data = (T *)realloc(self->data, sizeof(T) * alloc_size);                     \
+    if (data == NULL) {                                                             \
+        return ERR_OOM;                                                             \
+    }                                                                               \
+    self->data = data;                                                              \
+    self->alloc_size = alloc_size;                                                  \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline int name##_insert(name *self, size_t index, T value) {                \
+    return_val_if_fail(self != NULL, ERR_NIL);                                      \
+    if (self->size == self->alloc_size && name##_reserve(self, self->size + 1) != OK) { \
+        return ERR_OOM;                                                             \
+    }                                                                               \
+    index = index < self->size ? index : self->size;                                \
+    memmove(self->data + index + 1, self->data + index,                             \
+            (self->size - index) * sizeof(T));                                      \
+    self->data[index] = value;                                                      \
+    self->size++;                                                                   \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline int name##_append(name *self, T value) {                              \
+    return_val_if_fail(self != NULL, ERR_NIL);                                      \
+    if (self->size == self->alloc_size && name##_reserve(self, self->size + 1) != OK) { \
+        return ERR_OOM;                                                             \
+    }                                                                               \
+    self->data[self->size++] = value;                                               \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline int name##_delete(name *self, size_t index) {                         \
+    return_val_if_fail(self != NULL && index < self->size, ERR_NIL);                \
+    memmove(self->data + index, self->data + index + 1,                             \
+            (self->size - index - 1) * sizeof(T));                                  \
+    self->size--;                                                                   \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline T *name##_at(name *self, size_t index) {                              \
+    return_val_if_fail(self != NULL && index < self->size, NULL);                   \
+    return &self->data[index];                                                      \
+}                                                                                   \
+                                                                                    \
+static inline size_t name##_length(name *self) {                                    \
+    return_val_if_fail(self != NULL, 0);                                            \
+    return self->size;                                                              \
+}                                                                                   \
+                                                                                    \
+static inline void name##_destroy(name *self) {                                     \
+    if (self != NULL) {                                                             \
+        STL_FREE(self->data);                                                       \
+        STL_FREE(self);                                                             \
+    }                                                                               \
+}
+
+#endif /*TYPED_ARRAY_H*/
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "typed_array.h"
+#include "typed_map.h"
+#include "typed_sort.h"
+
+// Array of ints stored by value
+CSTL_ARRAY_DECLARE(IntArray, int)
+
+// Sort for plain int buffers using the default ordering
+CSTL_SORT_DECLARE(int, int, CSTL_LESS)
+
+// Equality for string keys
+#define str_eq(a, b) (strcmp((a), (b)) == 0)
+
+// Map from string keys to int values
+CSTL_MAP_DECLARE(StrIntMap, const char *, int, cstl_hash_str, str_eq)
+
+// Function to visit key-value pairs during map traversal
+BOOL kv_visit(void* ctx, const char** key, int* value) {
+    printf("key:%s, value:%d\n", *key, *value);
+    return TRUE;
+}
+
+int main() {
+    // Seed the random number generator
+    unsigned int seed = (unsigned int)(time(NULL) + clock());
+    srand(seed);
+
+    // Populate the array with random integers, no per-element allocation needed
+    IntArray *array = IntArray_create();
+    for (int i = 0; i < 1000000; i++) {
+        IntArray_append(array, rand());
+    }
+
+    // Sort the elements in place with the comparison inlined
+    int_sort(array->data, IntArray_length(array));
+    printf("min:%d, max:%d\n", *IntArray_at(array, 0), *IntArray_at(array, IntArray_length(array) - 1));
+    IntArray_destroy(array);
+
+    // Count words with a typed map
+    const char *words[] = {"apple", "banana", "apple", "cherry", "banana", "apple"};
+    StrIntMap *map = StrIntMap_create();
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        int *count = StrIntMap_find(map, words[i]);
+        if (count != NULL) {
+            (*count)++;
+        } else {
+            StrIntMap_set(map, words[i], 1);
+        }
+    }
+
+    StrIntMap_delete(map, "cherry");
+    printf("size:%zu\n", StrIntMap_length(map));
+    StrIntMap_foreach(map, kv_visit, NULL);
+
+    StrIntMap_destroy(map);
+    return 0;
+}
@@ -0,0 +1,215 @@
+#ifndef TYPED_MAP_H
+#define TYPED_MAP_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "typedef.h"
+
+// Compile-time specialized hash map storing K and V by value.
+//
+// CSTL_MAP_DECLARE(name, K, V, hash, eq) generates a struct `name` and
+//     name* name_create(void);
+//     int   name_set(name* self, K key, V value);      // insert or replace
+//     int   name_get(name* self, K key, V* value);     // OK or ERR_NIL
+//     V*    name_find(name* self, K key);              // NULL when absent
+//     int   name_delete(name* self, K key);
+//     size_t name_length(name* self);
+//     int   name_foreach(name* self, name_visit_func visit, void* ctx);
+//     void  name_destroy(name* self);
+// hash(key) returns an integer hash and eq(a, b) returns non-zero for equal
+// keys; both may be functions or function-like macros and are expanded
+// inline. Entries are stored in a single open-addressing slot array with
+// Robin Hood probing. The generic Map in map.h corresponds to the
+// void* instance with runtime hash and compare callbacks.
+
+// Function to spread the bits of a hash so weak hashes still use the whole table
+static inline uint64_t cstl_hash_mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Function to hash a NUL-terminated string (FNV-1a)
+static inline uint64_t cstl_hash_str(const char *str) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*str != '\0') {
+        h ^= (unsigned char)*str++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Equality for arithmetic keys
+#define CSTL_EQ(a, b) ((a) == (b))
+
+#define CSTL_MAP_MIN_SLOT_SIZE 16
+
+#define CSTL_MAP_DECLARE(name, K, V, hash, eq)                                      \
+                                                                                    \
+typedef struct {                                                                    \
+    K key;                                                                          \
+    V value;                                                                        \
+    uint64_t hash; /* 0 marks an empty slot */                                      \
+} name##_entry;                                                                     \
+                                                                                    \
+typedef struct {                                                                    \
+    name##_entry *slots;                                                            \
+    size_t slot_n;                                                                  \
+    size_t size;                                                                    \
+} name;                                                                             \
+                                                                                    \
+typedef BOOL (*name##_visit_func)(void *ctx, K *key, V *value);                     \
+                                                                                    \
+static inline uint64_t name##_hash(K key) {                                         \
+    uint64_t h = cstl_hash_mix64((uint64_t)(hash(key)));                            \
+    return h != 0 ? h : 1;                                                          \
+}                                                                                   \
+                                                                                    \
+static inline name *name##_create(void) {                                           \
+    name *self = (name *)STL_MALLOC(sizeof(name));                                  \
+    if (self != NULL) {                                                             \
+        self->slot_n = CSTL_MAP_MIN_SLOT_SIZE;                                      \
+        self->size = 0;                                                             \
+        self->slots = (name##_entry *)STL_MALLOC(sizeof(name##_entry) * self->slot_n); \
+        if (self->slots == NULL) {                                                  \
+            STL_FREE(self);                                                         \
+        }                                                                           \
+    }                                                                               \
+    return self;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline name##_entry *name##_lookup(name *self, K key, uint64_t h) {          \
+    size_t mask = self->slot_n - 1;                                                 \
+    size_t pos = (size_t)h & mask;                                                  \
+    for (size_t dist = 0;; dist++, pos = (pos + 1) & mask) {                        \
+        name##_entry *entry = &self->slots[pos];                                    \
+        if (entry->hash == 0 || ((pos - (size_t)entry->hash) & mask) < dist) {      \
+            return NULL;                                                            \
+        }                                                                           \
+        if (entry->hash == h && eq(entry->key, key)) {                              \
+            return entry;                                                           \
+        }                                                                           \
+    }                                                                               \
+}                                                                                   \
+                                                                                    \
+static inline void name##_place(name##_entry *slots, size_t slot_n, name##_entry entry) { \
+    size_t mask = slot_n - 1;                                                       \
+    size_t pos = (size_t)entry.hash & mask;                                         \
+    for (size_t dist = 0;; dist++, pos = (pos + 1) & mask) {                        \
+        name##_entry *slot = &slots[pos];                                           \
+        if (slot->hash == 0) {                                                      \
+            *slot = entry;                                                          \
+            return;                                                                 \
+        }                                                                           \
+        size_t slot_dist = (pos - (size_t)slot->hash) & mask;                       \
+        if (slot_dist < dist) {                                                     \
+            name##_entry tmp = *slot;                                               \
+            *slot = entry;                                                          \
+            entry = tmp;                                                            \
+            dist = slot_dist;                                                       \
+        }                                                                           \
+    }                                                                               \
+}                                                                                   \
+                                                                                    \
+static inline int name##_expand(name *self) {                                       \
+    size_t slot_n = self->slot_n * 2;                                               \
+    name##_entry *slots = (name##_entry *)STL_MALLOC(sizeof(name##_entry) * slot_n); \
+    if (slots == NULL) {                                                            \
+        return ERR_OOM;                                                             \
+    }                                                                               \
+    for (size_t i = 0; i < self->slot_n; i++) {                                     \
+        if (self->slots[i].hash != 0) {                                             \
+            name##_place(slots, slot_n, self->slots[i]);                            \
+        }                                                                           \
+    }                                                                               \
+    STL_FREE(self->slots);                                                          \
+    self->slots = slots;                                                            \
+    self->slot_n = slot_n;                                                          \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline int name##_set(name *self, K key, V value) {                          \
+    return_val_if_fail(self != NULL, ERR_NIL);                                      \
+    uint64_t h = name##_hash(key);                                                  \
+    name##_entry *entry = name##_lookup(self, key, h);                              \
+    if (entry != NULL) {                                                            \
+        entry->value = value;                                                       \
+        return OK;                                                                  \
+    }                                                                               \
+    if ((self->size + 1) * 8 > self->slot_n * 7 && name##_expand(self) != OK) {     \
+        return ERR_OOM;                                                             \
+    }                                                                               \
+    name##_entry kv;                                                                \
+    kv.key = key;                                                                   \
+    kv.value = value;                                                               \
+    kv.hash = h;                                                                    \
+    name##_place(self->slots, self->slot_n, kv);                                    \
+    self->size++;                                                                   \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline V *name##_find(name *self, K key) {                                   \
+    return_val_if_fail(self != NULL, NULL);                                         \
+    name##_entry *entry = name##_lookup(self, key, name##_hash(key));               \
+    return entry != NULL ? &entry->value : NULL;                                    \
+}                                                                                   \
+                                                                                    \
+static inline int name##_get(name *self, K key, V *value) {                         \
+    return_val_if_fail(self != NULL && value != NULL, ERR_NIL);                     \
+    V *found = name##_find(self, key);                                              \
+    if (found == NULL) {                                                            \
+        return ERR_NIL;                                                             \
+    }                                                                               \
+    *value = *found;                                                                \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline int name##_delete(name *self, K key) {                                \
+    return_val_if_fail(self != NULL, ERR_NIL);                                      \
+    name##_entry *entry = name##_lookup(self, key, name##_hash(key));               \
+    if (entry == NULL) {                                                            \
+        return ERR_NIL;                                                             \
+    }                                                                               \
+    /* Backward-shift the following entries instead of leaving a tombstone */       \
+    size_t mask = self->slot_n - 1;                                                 \
+    size_t pos = (size_t)(entry - self->slots);                                     \
+    size_t next = (pos + 1) & mask;                                                 \
+    while (self->slots[next].hash != 0                                              \
+           && ((next - (size_t)self->slots[next].hash) & mask) != 0) {              \
+        self->slots[pos] = self->slots[next];                                       \
+        pos = next;                                                                 \
+        next = (next + 1) & mask;                                                   \
+    }                                                                               \
+    self->slots[pos].hash = 0;                                                      \
+    self->size--;                                                                   \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline size_t name##_length(name *self) {                                    \
+    return_val_if_fail(self != NULL, 0);                                            \
+    return self->size;                                                              \
+}                                                                                   \
+                                                                                    \
+static inline int name##_foreach(name *self, name##_visit_func visit, void *ctx) {  \
+    return_val_if_fail(self != NULL && visit != NULL, ERR_NIL);                     \
+    for (size_t i = 0; i < self->slot_n; i++) {                                     \
+        name##_entry *entry = &self->slots[i];                                      \
+        if (entry->hash != 0 && !visit(ctx, &entry->key, &entry->value)) {          \
+            break;                                                                  \
+        }                                                                           \
+    }                                                                               \
+    return OK;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline void name##_destroy(name *self) {                                     \
+    if (self != NULL) {                                                             \
+        STL_FREE(self->slots);                                                      \
+        STL_FREE(self);                                                             \
+    }                                                                               \
+}
+
+#endif /*TYPED_MAP_H*/
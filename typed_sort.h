@@ -0,0 +1,166 @@
+#ifndef TYPED_SORT_H
+#define TYPED_SORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "typedef.h"
+
+// Compile-time specialized introsort over a plain T* buffer.
+//
+// CSTL_SORT_DECLARE(name, T, less) generates
+//     static inline void name_sort(T* data, size_t n);
+// where less(a, b) is a function or function-like macro taking two T values
+// and returning non-zero when a orders before b. Elements are moved by value
+// and the comparison is expanded inline, so the compiler can optimize the
+// whole sort for T. quick_sort_ptr in sort.h is the generic void* instance.
+
+// Default ordering for arithmetic types
+#define CSTL_LESS(a, b) ((a) < (b))
+
+#define CSTL_SORT_DECLARE(name, T, less)                                            \
+                                                                                    \
+static inline void name##_sort_insertion(T *data, size_t low, size_t high) {        \
+    for (size_t i = low + 1; i <= high; i++) {                                      \
+        T current = data[i];                                                        \
+        size_t j = i;                                                               \
+        while (j > low && less(current, data[j - 1])) {                             \
+            data[j] = data[j - 1];                                                  \
+            j--;                                                                    \
+        }                                                                           \
+        data[j] = current;                                                          \
+    }                                                                               \
+}                                                                                   \
+                                                                                    \
+static inline void name##_sort_sift_down(T *data, size_t root, size_t n) {          \
+    T current = data[root];                                                         \
+    size_t child;                                                                   \
+    while ((child = 2 * root + 1) < n) {                                            \
+        if (child + 1 < n && less(data[child], data[child + 1])) {                  \
+            child++;                                                                \
+        }                                                                           \
+        if (!less(current, data[child])) {                                          \
+            break;                                                                  \
+        }                                                                           \
+        data[root] = data[child];                                                   \
+        root = child;                                                               \
+    }                                                                               \
+    data[root] = current;                                                           \
+}                                                                                   \
+                                                                                    \
+static inline void name##_sort_heap(T *data, size_t n) {                            \
+    for (size_t i = n / 2; i > 0; i--) {                                            \
+        name##_sort_sift_down(data, i - 1, n);                                      \
+    }                                                                               \
+    while (n > 1) {                                                                 \
+        n--;                                                                        \
+        T tmp = data[0];                                                            \
+        data[0] = data[n];                                                          \
+        data[n] = tmp;                                                              \
+        name##_sort_sift_down(data, 0, n);                                          \
+    }                                                                               \
+}                                                                                   \
+                                                                                    \
+static inline void name##_sort_median3(T *data, size_t a, size_t b, size_t c) {     \
+    T tmp;                                                                          \
+    if (less(data[b], data[a])) {                                                   \
+        tmp = data[a]; data[a] = data[b]; data[b] = tmp;                            \
+    }                                                                               \
+    if (less(data[c], data[b])) {                                                   \
+        tmp = data[b]; data[b] = data[c]; data[c] = tmp;                            \
+        if (less(data[b], data[a])) {                                               \
+            tmp = data[a]; data[a] = data[b]; data[b] = tmp;                        \
+        }                                                                           \
+    }                                                                               \
+}                                                                                   \
+                                                                                    \
+static inline size_t name##_sort_partition(T *data, size_t low, size_t high) {      \
+    size_t n = high - low + 1;                                                      \
+    size_t mid = low + n / 2;                                                       \
+    if (n > 128) {                                                                  \
+        size_t step = n / 8;                                                        \
+        name##_sort_median3(data, low, low + step, low + 2 * step);                 \
+        name##_sort_median3(data, mid - step, mid, mid + step);                     \
+        name##_sort_median3(data, high - 2 * step, high - step, high);              \
+        name##_sort_median3(data, low + step, mid, high - step);                    \
+    } else {                                                                        \
+        name##_sort_median3(data, low, mid, high);                                  \
+    }                                                                               \
+    T pivot = data[mid];                                                            \
+    data[mid] = data[low];                                                          \
+    data[low] = pivot;                                                              \
+    size_t i = low;                                                                 \
+    size_t j = high + 1;                                                            \
+    while (1) {                                                                     \
+        do {                                                                        \
+            i++;                                                                    \
+        } while (i <= high && less(data[i], pivot));                                \
+        do {                                                                        \
+            j--;                                                                    \
+        } while (less(pivot, data[j]));                                             \
+        if (i >= j) {                                                               \
+            break;                                                                  \
+        }                                                                           \
+        T tmp = data[i];                                                            \
+        data[i] = data[j];                                                          \
+        data[j] = tmp;                                                              \
+    }                                                                               \
+    data[low] = data[j];                                                            \
+    data[j] = pivot;                                                                \
+    return j;                                                                       \
+}                                                                                   \
+                                                                                    \
+static inline void name##_sort(T *data, size_t n) {                                 \
+    struct { size_t low, high, depth; } stack[64];                                  \
+    size_t top = 0;                                                                 \
+    size_t depth = 0;                                                               \
+    if (data == NULL || n < 2) {                                                    \
+        return;                                                                     \
+    }                                                                               \
+    for (size_t m = n; m > 1; m >>= 1) {                                            \
+        depth += 2;                                                                 \
+    }                                                                               \
+    stack[top].low = 0;                                                             \
+    stack[top].high = n - 1;                                                        \
+    stack[top++].depth = depth;                                                     \
+    while (top > 0) {                                                               \
+        top--;                                                                      \
+        size_t low = stack[top].low;                                                \
+        size_t high = stack[top].high;                                              \
+        depth = stack[top].depth;                                                   \
+        while (high - low + 1 > 16) {                                               \
+            if (depth == 0) {                                                       \
+                name##_sort_heap(data + low, high - low + 1);                       \
+                break;                                                              \
+            }                                                                       \
+            depth--;                                                                \
+            size_t mid = name##_sort_partition(data, low, high);                    \
+            if (mid - low > high - mid) {                                           \
+                if (mid > low + 1) {                                                \
+                    stack[top].low = low;                                           \
+                    stack[top].high = mid - 1;                                      \
+                    stack[top++].depth = depth;                                     \
+                }                                                                   \
+                low = mid + 1;                                                      \
+            } else {                                                                \
+                if (mid + 1 < high) {                                               \
+                    stack[top].low = mid + 1;                                       \
+                    stack[top].high = high;                                         \
+                    stack[top++].depth = depth;                                     \
+                }                                                                   \
+                if (mid == low) {                                                   \
+                    low = high;                                                     \
+                } else {                                                            \
+                    high = mid - 1;                                                 \
+                }                                                                   \
+            }                                                                       \
+            if (low >= high) {                                                      \
+                break;                                                              \
+            }                                                                       \
+        }                                                                           \
+        if (low < high && high - low + 1 <= 16) {                                   \
+            name##_sort_insertion(data, low, high);                                 \
+        }                                                                           \
+    }                                                                               \
+}
+
+#endif /*TYPED_SORT_H*/
@@ -7,6 +7,10 @@
 #define OK 0
 #define ERR_NIL (-1)
 #define ERR_OOM (-2)
+#define ERR_EXIST (-3)
+#define ERR_FULL (-4)
+#define ERR_TIMEOUT (-5)
+#define ERR_IO (-6)
 
 typedef int BOOL;
 #define TRUE (1)
@@ -21,6 +25,13 @@ typedef int BOOL;
     }\
 } while (0)
 
+// Macro to hint that memory at addr will be read soon, a no-op on compilers without a prefetch builtin
+#if defined(__GNUC__) || defined(__clang__)
+#define STL_PREFETCH(addr) __builtin_prefetch((addr))
+#else
+#define STL_PREFETCH(addr) ((void)(addr))
+#endif
+
 // Function pointer types for data handling
 typedef void (*DataDestroyFunc)(void* ctx, void* data);
 typedef int  (*DataCompareFunc)(void* ctx, void* data);
@@ -0,0 +1,170 @@
+#include <stdint.h>
+#include "work_deque.h"
+
+// The memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory Models"
+// (Le, Pop, Cohen, Zappa Nardelli, PPoPP 2013).
+
+// Function to allocate a buffer with capacity slots, or return NULL when its size would overflow
+// (a capacity doubled past SIZE_MAX arrives here as 0)
+static WorkDequeBuffer* work_deque_buffer_create(size_t capacity) {
+    if (capacity == 0 || capacity > (SIZE_MAX - sizeof(WorkDequeBuffer)) / sizeof(void*)) {
+        return NULL;
+    }
+    WorkDequeBuffer* buffer = (WorkDequeBuffer*)STL_MALLOC(sizeof(WorkDequeBuffer) + capacity * sizeof(void*));
+    if (buffer != NULL) {
+        buffer->capacity = capacity;
+        buffer->prev = NULL;
+    }
+    return buffer;
+}
+
+// Function to get the slot holding position pos
+static inline _Atomic(void*)* work_deque_slot(WorkDequeBuffer* buffer, int64_t pos) {
+    return &buffer->data[(size_t)pos & (buffer->capacity - 1)];
+}
+
+// Function to create a deque with room for capacity elements before it grows (rounded up to a power of two)
+WorkDeque* work_deque_create(size_t capacity, DataDestroyFunc data_destroy, void* ctx) {
+    // Rounding capacity up to a power of two must not overflow; the buffer checks its own size
+    return_val_if_fail(capacity <= SIZE_MAX / 2 + 1, NULL);
+    size_t slots = 2;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    // Over-allocate by one cache line and align the deque inside the block
+    void* mem = STL_MALLOC(sizeof(WorkDeque) + WORK_DEQUE_CACHE_LINE);
+    if (mem == NULL) {
+        return NULL;
+    }
+    WorkDeque* self = (WorkDeque*)(((uintptr_t)mem + WORK_DEQUE_CACHE_LINE - 1)
+                                   & ~(uintptr_t)(WORK_DEQUE_CACHE_LINE - 1));
+    WorkDequeBuffer* buffer = work_deque_buffer_create(slots);
+    if (buffer == NULL) {
+        STL_FREE(mem);
+        return NULL;
+    }
+    atomic_init(&self->top, 0);
+    atomic_init(&self->bottom, 0);
+    atomic_init(&self->buffer, buffer);
+    self->data_destroy = data_destroy;
+    self->data_destroy_ctx = ctx;
+    self->mem = mem;
+    return self;
+}
+
+// Function to replace a full buffer with one twice its size, copying the elements between top and bottom
+static WorkDequeBuffer* work_deque_grow(WorkDeque* self, WorkDequeBuffer* buffer, int64_t top, int64_t bottom) {
+    WorkDequeBuffer* grown = work_deque_buffer_create(buffer->capacity << 1);
+    if (grown == NULL) {
+        return NULL;
+    }
+    for (int64_t i = top; i < bottom; i++) {
+        void* data = atomic_load_explicit(work_deque_slot(buffer, i), memory_order_relaxed);
+        atomic_store_explicit(work_deque_slot(grown, i), data, memory_order_relaxed);
+    }
+    grown->prev = buffer;
+    // Release publishes the copied slots to thieves that load the new buffer
+    atomic_store_explicit(&self->buffer, grown, memory_order_release);
+    return grown;
+}
+
+// Function to push an element at the bottom, called by the owner thread only
+int work_deque_push(WorkDeque* self, void* data) {
+    return_val_if_fail(self != NULL, ERR_NIL);
+    int64_t bottom = atomic_load_explicit(&self->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&self->top, memory_order_acquire);
+    WorkDequeBuffer* buffer = atomic_load_explicit(&self->buffer, memory_order_relaxed);
+
+    if (bottom - top >= (int64_t)buffer->capacity) {
+        if ((buffer = work_deque_grow(self, buffer, top, bottom)) == NULL) {
+            return ERR_OOM;
+        }
+    }
+    atomic_store_explicit(work_deque_slot(buffer, bottom), data, memory_order_relaxed);
+    // Release publishes the slot, and whatever the element points to, before thieves can observe the new bottom
+    atomic_store_explicit(&self->bottom, bottom + 1, memory_order_release);
+    return OK;
+}
+
+// Function to pop the most recently pushed element, called by the owner thread only. Returns ERR_NIL when empty.
+int work_deque_pop(WorkDeque* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    int64_t bottom = atomic_load_explicit(&self->bottom, memory_order_relaxed) - 1;
+    WorkDequeBuffer* buffer = atomic_load_explicit(&self->buffer, memory_order_relaxed);
+
+    // Claim the bottom slot first, then look at top: the full fence keeps a thief from
+    // reading the old bottom after this thread has read an old top
+    atomic_store_explicit(&self->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&self->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty, undo the claim
+        atomic_store_explicit(&self->bottom, bottom + 1, memory_order_relaxed);
+        return ERR_NIL;
+    }
+
+    *data = atomic_load_explicit(work_deque_slot(buffer, bottom), memory_order_relaxed);
+    if (top == bottom) {
+        // Last element: race the thieves for it through top
+        int ret = atomic_compare_exchange_strong_explicit(&self->top, &top, top + 1,
+                                                          memory_order_seq_cst, memory_order_relaxed) ? OK : ERR_NIL;
+        atomic_store_explicit(&self->bottom, bottom + 1, memory_order_relaxed);
+        return ret;
+    }
+    return OK;
+}
+
+// Function to steal the oldest element, from any thread.
+// Returns ERR_NIL when the deque is empty or another thread took the element first.
+int work_deque_steal(WorkDeque* self, void** data) {
+    return_val_if_fail(self != NULL && data != NULL, ERR_NIL);
+    int64_t top = atomic_load_explicit(&self->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&self->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return ERR_NIL;
+    }
+    WorkDequeBuffer* buffer = atomic_load_explicit(&self->buffer, memory_order_acquire);
+    void* stolen = atomic_load_explicit(work_deque_slot(buffer, top), memory_order_relaxed);
+    // The slot is only ours if top has not moved since it was read
+    if (!atomic_compare_exchange_strong_explicit(&self->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return ERR_NIL;
+    }
+    *data = stolen;
+    return OK;
+}
+
+// Function to get the number of elements in the deque, a snapshot while other threads run
+size_t work_deque_length(WorkDeque* self) {
+    return_val_if_fail(self != NULL, 0);
+    int64_t top = atomic_load_explicit(&self->top, memory_order_acquire);
+    int64_t bottom = atomic_load_explicit(&self->bottom, memory_order_acquire);
+    // bottom sits one below top while the owner pops from an empty deque
+    return bottom > top ? (size_t)(bottom - top) : 0;
+}
+
+// Function to destroy the deque and the elements left in it, once no thread uses it
+void work_deque_destroy(WorkDeque* self) {
+    if (self != NULL) {
+        int64_t top = atomic_load_explicit(&self->top, memory_order_relaxed);
+        int64_t bottom = atomic_load_explicit(&self->bottom, memory_order_relaxed);
+        WorkDequeBuffer* buffer = atomic_load_explicit(&self->buffer, memory_order_relaxed);
+        if (self->data_destroy != NULL) {
+            for (; top < bottom; top++) {
+                self->data_destroy(self->data_destroy_ctx,
+                                   atomic_load_explicit(work_deque_slot(buffer, top), memory_order_relaxed));
+            }
+        }
+        while (buffer != NULL) {
+            WorkDequeBuffer* prev = buffer->prev;
+            STL_FREE(buffer);
+            buffer = prev;
+        }
+        void* mem = self->mem;
+        STL_FREE(mem);
+    }
+}
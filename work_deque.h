@@ -0,0 +1,53 @@
+#ifndef WORK_DEQUE_H
+#define WORK_DEQUE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "typedef.h"
+
+#define WORK_DEQUE_CACHE_LINE 64
+
+// Structure representing the circular buffer of a work deque.
+// Buffers replaced by a larger one stay allocated until the deque is destroyed,
+// because a thief may still be reading a slot of the old one.
+typedef struct WorkDequeBuffer {
+    size_t capacity;                // Number of slots, a power of two
+    struct WorkDequeBuffer* prev;   // Buffer this one replaced
+    _Atomic(void*) data[];          // Slots, indexed by position modulo capacity
+} WorkDequeBuffer;
+
+// Structure representing a Chase-Lev work-stealing deque.
+// One owner thread pushes and pops at the bottom like a stack, without locks in the common case;
+// any other thread may steal from the top. The buffer grows when the owner pushes into a full deque.
+typedef struct {
+    // Written by thieves
+    _Alignas(WORK_DEQUE_CACHE_LINE) _Atomic(int64_t) top;      // Next position to steal
+    // Written by the owner
+    _Alignas(WORK_DEQUE_CACHE_LINE) _Atomic(int64_t) bottom;   // Next position to push
+    _Atomic(WorkDequeBuffer*) buffer;                           // Current buffer
+    DataDestroyFunc data_destroy;                               // Function to destroy elements left at destruction
+    void* data_destroy_ctx;                                     // Context for data destruction
+    void* mem;                                                  // Allocation the aligned deque lives in
+} WorkDeque;
+
+// Function to create a deque with room for capacity elements before it grows (rounded up to a power of two)
+WorkDeque* work_deque_create(size_t capacity, DataDestroyFunc data_destroy, void* ctx);
+
+// Function to push an element at the bottom, called by the owner thread only
+int work_deque_push(WorkDeque* self, void* data);
+
+// Function to pop the most recently pushed element, called by the owner thread only. Returns ERR_NIL when empty.
+int work_deque_pop(WorkDeque* self, void** data);
+
+// Function to steal the oldest element, from any thread.
+// Returns ERR_NIL when the deque is empty or another thread took the element first.
+int work_deque_steal(WorkDeque* self, void** data);
+
+// Function to get the number of elements in the deque, a snapshot while other threads run
+size_t work_deque_length(WorkDeque* self);
+
+// Function to destroy the deque and the elements left in it, once no thread uses it
+void work_deque_destroy(WorkDeque* self);
+
+#endif /*WORK_DEQUE_H*/